@@ -1,5 +1,3 @@
-use regex::Regex;
-
 use crate::structures::individual::Individual;
 
 use serde::{Deserialize, Serialize};
@@ -17,6 +15,8 @@ pub struct Outcome {
     pub used_host_consumption: f32,
     pub idle_host_consumption: f32,
     pub total_link_consumption: f32,
+    /// Hosts, links and disks. Disks consume energy on platforms giving them `wattage_idle` and
+    /// `wattage_read` properties, even when trainers don't read their dataset from them.
     pub total_consumption: f32,
     pub simulation_time: f32,
 }
@@ -27,8 +27,11 @@ pub fn run_simulation(
     ind: Individual,
     write_logs: bool,
 ) -> Outcome {
+    // Individuals kept across generations are simulated with the same inputs, let the simulator reuse their results
+    let cache_dir_arg = format!("--cache-dir={output_dir}/simulation-cache");
+
     let output = Command::new("falafels-simulator")
-        .args([&ind.get_platform_path(), &ind.get_ff_path()])
+        .args([&ind.get_platform_path(), &ind.get_ff_path(), &cache_dir_arg])
         .output()
         .expect("failed to execute process");
 
@@ -44,12 +47,7 @@ pub fn run_simulation(
 
     let logs = String::from_utf8(output.stderr).unwrap();
 
-    let [total_host_consumption, used_host_consumption, idle_host_consumption] =
-        parse_host_energy_results(&logs);
-
-    let total_link_consumption = parse_link_energy_results(&logs);
-
-    let simulation_time = parse_simulation_time(&logs);
+    let result = parse_simulation_result(&logs);
 
     Outcome {
         individual_name: ind.meta.name.clone(),
@@ -59,120 +57,72 @@ pub fn run_simulation(
             ind.get_platform_path(),
             ind.get_ff_path()
         ),
-        total_host_consumption,
-        used_host_consumption,
-        idle_host_consumption,
-        total_link_consumption,
-        total_consumption: total_host_consumption + total_link_consumption,
-        simulation_time,
+        total_host_consumption: result.total_host_consumption,
+        used_host_consumption: result.used_host_consumption,
+        idle_host_consumption: result.idle_host_consumption,
+        total_link_consumption: result.total_link_consumption,
+        total_consumption: result.total_host_consumption
+            + result.total_link_consumption
+            + result.total_disk_consumption,
+        simulation_time: result.simulation_time,
     }
 }
 
-///
-///
-/// Return: total_host_consumption, used_host_consumption, idle_host_consumption
-fn parse_host_energy_results(logs: &String) -> [f32; 3] {
-    // Look for the line containing host energy informations
-    let hosts_consumption = logs
-        .lines()
-        .rev() // Reverse the iterator because we know the result is at the end
-        .find(|l| l.contains("Total energy consumption"))
-        .expect(&format!(
-            "{}\n Couldn't find 'Total energy consumption' in the logs.",
-            logs
-        ));
-
-    // Match every floating numbers with varying digit number
-    let re = Regex::new(r"([0-9]+\.[0-9]+)").unwrap();
-
-    // Captures each floating number in the line containing energy consumption information and
-    // creates a vector of owned string
-    let v = re
-        .captures_iter(hosts_consumption)
-        .map(
-            // Parse each value into f32
-            |n| {
-                n[0].parse::<f32>().expect(&format!(
-                    "Couldn't parse value `{}` into f32",
-                    n[0].to_owned()
-                ))
-            },
-        )
-        .skip(1) // Skip simulation time
-        .take(3)
-        .collect::<Vec<f32>>();
-
-    // Verify we obtained exactly 3 values and return a fixed size array.
-    <[f32; 3]>::try_from(v).ok().expect(&format!(
-        "Failed to capture 3 FP values on line: {hosts_consumption}"
-    ))
+/// Values of the structured result line written by the simulator at the end of a simulation, or
+/// when its result was found in the cache.
+#[derive(Debug, Default)]
+struct SimulationResult {
+    simulation_time: f32,
+    total_host_consumption: f32,
+    used_host_consumption: f32,
+    idle_host_consumption: f32,
+    total_link_consumption: f32,
+    total_disk_consumption: f32,
 }
 
+/// Parse the line formatted as `Simulation result: key=value key=value...`
 ///
-///
-/// Return: total_link_consumption
-fn parse_link_energy_results(logs: &String) -> f32 {
-    // Look for the line containing link energy informations
-    let links_consumption = logs
+/// Return: SimulationResult
+fn parse_simulation_result(logs: &String) -> SimulationResult {
+    // Look for the line containing the result
+    let result_line = logs
         .lines()
         .rev() // Reverse the iterator because we know the result is at the end
-        .find(|l| l.contains("Total energy over all links"))
+        .find(|l| l.contains("Simulation result"))
         .expect(&format!(
-            "{}\n Couldn't find 'Total energy over all links' in the logs.",
+            "{}\n Couldn't find 'Simulation result' in the logs.",
             logs
         ));
 
-    // Match every floating numbers with varying digit number
-    let re = Regex::new(r"([0-9]+\.[0-9]+)").unwrap();
-
-    let link_energy = re
-        .captures_iter(links_consumption)
-        .map(|n| {
-            n[0].parse::<f32>().expect(&format!(
-                "Couldn't parse value `{}` into f32",
-                n[0].to_owned()
-            ))
-        })
-        .skip(1) // Skip simulation time
-        .take(1) // Take energy
-        .next();
-
-    // Verify we obtained a value and return it
-    link_energy.expect(&format!(
-        "Failed to capture 1 FP values on line: {links_consumption}"
-    ))
-}
+    let mut result = SimulationResult::default();
+    let mut nb_fields = 0;
 
-///
-///
-/// Return: simulation_time
-fn parse_simulation_time(logs: &String) -> f32 {
-    // Look for the line containing host energy informations
-    let simulation_over = logs
-        .lines()
-        .rev() // Reverse the iterator because we know the result is at the end
-        .find(|l| l.contains("Total energy over all links"))
-        .expect(&format!(
-            "{}\n Couldn't find 'Total energy over all links' in the logs.",
-            logs
+    for (key, value) in result_line
+        .split_whitespace()
+        .filter_map(|token| token.split_once('='))
+    {
+        let value = value.parse::<f32>().expect(&format!(
+            "Couldn't parse value `{}` of `{}` into f32",
+            value, key
         ));
 
-    // Match every floating numbers with varying digit number
-    let re = Regex::new(r"([0-9]+\.[0-9]+)").unwrap();
-
-    let simulation_time = re
-        .captures_iter(simulation_over)
-        .map(|n| {
-            n[0].parse::<f32>().expect(&format!(
-                "Couldn't parse value `{}` into f32",
-                n[0].to_owned()
-            ))
-        })
-        .take(1) // Take simulation time
-        .next();
-
-    // Verify we obtained a value and return it
-    simulation_time.expect(&format!(
-        "Failed to capture 1 FP values on line: {simulation_over}"
-    ))
+        match key {
+            "simulation_time" => result.simulation_time = value,
+            "total_host_consumption" => result.total_host_consumption = value,
+            "used_host_consumption" => result.used_host_consumption = value,
+            "idle_host_consumption" => result.idle_host_consumption = value,
+            "total_link_consumption" => result.total_link_consumption = value,
+            "total_disk_consumption" => result.total_disk_consumption = value,
+            _ => continue,
+        }
+
+        nb_fields += 1;
+    }
+
+    assert!(
+        nb_fields == 6,
+        "Failed to capture the 6 values on line: {result_line}"
+    );
+
+    result
 }
@@ -0,0 +1,324 @@
+/* Scaling benchmark of the simulator */
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+
+/** Outcome of one run of the simulator */
+struct BenchResult
+{
+    string topology;
+    uint64_t number_trainers;
+    int exit_status;
+    double wall_clock_time;
+    /** In kilobytes, as reported by getrusage */
+    long peak_rss;
+    double simulated_time;
+    uint64_t number_actors;
+    uint64_t number_packets;
+};
+
+/** Trainers of a hierarchical deployment are split into star clusters of this size */
+static const uint64_t HIERARCHICAL_CLUSTER_SIZE = 100;
+
+static string node_name(uint64_t index)
+{
+    return std::format("node-{}", index);
+}
+
+static uint64_t get_number_hierarchical_clusters(uint64_t number_trainers)
+{
+    return (number_trainers + HIERARCHICAL_CLUSTER_SIZE - 1) / HIERARCHICAL_CLUSTER_SIZE;
+}
+
+/**
+ * Write a platform made of a single SimGrid cluster, so that its size stays linear in the number of hosts.
+ * Hosts are named node-0 to node-{number_hosts - 1}.
+ */
+static void write_platform(const string &path, uint64_t number_hosts)
+{
+    ofstream file(path);
+
+    file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    file << "<!DOCTYPE platform SYSTEM \"https://simgrid.org/simgrid.dtd\">\n";
+    file << "<platform version=\"4.1\">\n";
+    file << std::format("    <cluster id=\"bench\" prefix=\"node-\" suffix=\"\" radical=\"0-{}\" speed=\"14.4Gf\" core=\"4\" "
+                        "bw=\"1.25GBps\" lat=\"50us\">\n", number_hosts - 1);
+    file << "        <prop id=\"wattage_per_state\" value=\"2.89:3.000:7.28\"/>\n";
+    file << "    </cluster>\n";
+    file << "</platform>\n";
+}
+
+static void write_trainer(ofstream &file, uint64_t index, uint64_t aggregator_index)
+{
+    file << std::format("        <node name=\"{}\">\n", node_name(index));
+    file << "            <trainer type=\"simple\"/>\n";
+    file << "            <network-manager>\n";
+    file << std::format("                <arg name=\"bootstrap-node\" value=\"{}\"/>\n", node_name(aggregator_index));
+    file << "            </network-manager>\n";
+    file << "        </node>\n";
+}
+
+static void write_aggregator(ofstream &file, uint64_t index, string type, optional<uint64_t> parent_index)
+{
+    file << std::format("        <node name=\"{}\">\n", node_name(index));
+    file << std::format("            <aggregator type=\"{}\">\n", type);
+    file << "                <arg name=\"is_main_aggregator\" value=\"1\"/>\n";
+    file << "                <arg name=\"number_local_epochs\" value=\"1\"/>\n";
+    if (parent_index)
+        file << std::format("                <arg name=\"parent_aggregator_name\" value=\"{}\"/>\n", node_name(*parent_index));
+    file << "            </aggregator>\n";
+    file << "            <network-manager/>\n";
+    file << "        </node>\n";
+}
+
+/**
+ * Write a fried deployment of the given topology. node-0 is the main aggregator, followed by the trainers, and for
+ * hierarchical deployments by the aggregator of each star cluster.
+ *
+ * @return The number of hosts the deployment uses.
+ */
+static uint64_t write_fried(const string &path, const string &topology, uint64_t number_trainers, uint64_t number_rounds)
+{
+    ofstream file(path);
+
+    file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+    file << "<fried version=\"0.1\">\n";
+    file << "    <constants>\n";
+    file << "        <constant name=\"MODEL_SIZE_BYTES\" value=\"6655480\"/>\n";
+    file << "        <constant name=\"GLOBAL_MODEL_AGGREGATING_FLOPS\" value=\"1996044000.0\"/>\n";
+    file << "        <constant name=\"LOCAL_MODEL_TRAINING_FLOPS\" value=\"1996044000.0\"/>\n";
+    file << std::format("        <constant name=\"END_CONDITION_NUMBER_ROUNDS\" value=\"{}\"/>\n", number_rounds);
+    file << "        <constant name=\"REGISTRATION_TIMEOUT\" value=\"20\"/>\n";
+    file << "    </constants>\n";
+
+    uint64_t number_hosts = number_trainers + 1;
+
+    if (topology == "hierarchical")
+    {
+        uint64_t number_clusters = get_number_hierarchical_clusters(number_trainers);
+
+        for (uint64_t cluster = 0; cluster < number_clusters; cluster++)
+        {
+            uint64_t aggregator_index = number_trainers + 1 + cluster;
+            uint64_t first_trainer = 1 + cluster * HIERARCHICAL_CLUSTER_SIZE;
+            uint64_t last_trainer = min(number_trainers, first_trainer + HIERARCHICAL_CLUSTER_SIZE - 1);
+
+            file << "    <cluster topology=\"star\">\n";
+            for (uint64_t i = first_trainer; i <= last_trainer; i++)
+                write_trainer(file, i, aggregator_index);
+            write_aggregator(file, aggregator_index, "hierarchical", 0);
+            file << "    </cluster>\n";
+        }
+
+        file << "    <cluster topology=\"hierarchical\">\n";
+        write_aggregator(file, 0, "simple", nullopt);
+        file << "    </cluster>\n";
+
+        number_hosts += number_clusters;
+    }
+    else
+    {
+        file << std::format("    <cluster topology=\"{}\">\n", topology);
+        for (uint64_t i = 1; i <= number_trainers; i++)
+            write_trainer(file, i, 0);
+        write_aggregator(file, 0, "simple", nullopt);
+        file << "    </cluster>\n";
+    }
+
+    file << "</fried>\n";
+
+    return number_hosts;
+}
+
+/** Find the value of key in the line of the logs starting with prefix, formatted as `key=value key=value...` */
+static optional<string> find_log_value(const string &log_path, string_view prefix, string_view key)
+{
+    ifstream file(log_path);
+    string line;
+    optional<string> value;
+
+    // Keep the last matching line, as results are printed at the end
+    while (getline(file, line))
+    {
+        auto position = line.find(prefix);
+        if (position == string::npos)
+            continue;
+
+        stringstream tokens(line.substr(position + prefix.size()));
+        string token;
+
+        while (tokens >> token)
+        {
+            if (token.starts_with(key) && token.size() > key.size() && token[key.size()] == '=')
+                value = token.substr(key.size() + 1);
+        }
+    }
+
+    return value;
+}
+
+/** Run the simulator in a child process, measuring its wall clock time and peak memory usage */
+static BenchResult run_simulator(const string &simulator, const string &work_dir, const string &topology,
+                                 uint64_t number_trainers, uint64_t number_rounds)
+{
+    auto name = std::format("{}-{}", topology, number_trainers);
+    auto platform_path = std::format("{}/{}-platform.xml", work_dir, name);
+    auto fried_path = std::format("{}/{}-fried.xml", work_dir, name);
+    auto log_path = std::format("{}/{}.log", work_dir, name);
+
+    uint64_t number_hosts = write_fried(fried_path, topology, number_trainers, number_rounds);
+    write_platform(platform_path, number_hosts);
+
+    auto start = chrono::steady_clock::now();
+
+    pid_t pid = fork();
+
+    if (pid == 0)
+    {
+        // SimGrid logs on stderr
+        int log_fd = open(log_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        dup2(log_fd, STDERR_FILENO);
+        dup2(log_fd, STDOUT_FILENO);
+
+        execl(simulator.c_str(), simulator.c_str(), platform_path.c_str(), fried_path.c_str(), "--log=root.thres:critical",
+              "--log=s4u_main.thres:info", "--log=s4u_result.thres:info", (char *) nullptr);
+        _exit(127);
+    }
+
+    int status = 0;
+    struct rusage usage;
+    wait4(pid, &status, 0, &usage);
+
+    double wall_clock_time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    auto get_value = [&log_path](string_view prefix, string_view key) {
+        return find_log_value(log_path, prefix, key).value_or("0");
+    };
+
+    return BenchResult {
+        .topology = topology,
+        .number_trainers = number_trainers,
+        .exit_status = WIFEXITED(status) ? WEXITSTATUS(status) : -1,
+        .wall_clock_time = wall_clock_time,
+        .peak_rss = usage.ru_maxrss,
+        .simulated_time = stod(get_value("Simulation result:", "simulation_time")),
+        .number_actors = stoull(get_value("Simulation statistics:", "actors")),
+        .number_packets = stoull(get_value("Simulation statistics:", "packets")),
+    };
+}
+
+static string to_json(const vector<BenchResult> &results)
+{
+    stringstream json;
+    json << "[\n";
+
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        auto &r = results[i];
+
+        // Packets are the events driving the simulation, each one being at least a communication
+        double events_per_second = r.wall_clock_time > 0.0 ? r.number_packets / r.wall_clock_time : 0.0;
+
+        json << std::format(
+            "  {{\"topology\": \"{}\", \"trainers\": {}, \"exit_status\": {}, \"wall_clock_time\": {}, "
+            "\"peak_rss_kb\": {}, \"simulated_time\": {}, \"actors\": {}, \"packets\": {}, \"events_per_second\": {}}}{}\n",
+            r.topology, r.number_trainers, r.exit_status, r.wall_clock_time, r.peak_rss, r.simulated_time,
+            r.number_actors, r.number_packets, events_per_second, i + 1 < results.size() ? "," : ""
+        );
+    }
+
+    json << "]\n";
+    return json.str();
+}
+
+static vector<string> split(string_view list)
+{
+    vector<string> items;
+    stringstream stream{string(list)};
+    string item;
+
+    while (getline(stream, item, ','))
+        items.push_back(item);
+
+    return items;
+}
+
+int main(int argc, char* argv[])
+{
+    string simulator = FALAFELS_SIMULATOR_PATH;
+    vector<string> topologies = { "star", "ring-uni", "ring-bi", "hierarchical" };
+    vector<uint64_t> sizes = { 10, 100, 1000, 10000, 100000 };
+    uint64_t number_rounds = 3;
+    optional<string> output_path;
+
+    for (int i = 1; i < argc; i++)
+    {
+        string_view arg(argv[i]);
+
+        if (arg.starts_with("--simulator="))
+            simulator = arg.substr(string_view("--simulator=").size());
+        else if (arg.starts_with("--topologies="))
+            topologies = split(arg.substr(string_view("--topologies=").size()));
+        else if (arg.starts_with("--sizes="))
+        {
+            sizes.clear();
+            for (auto &size : split(arg.substr(string_view("--sizes=").size())))
+                sizes.push_back(stoull(size));
+        }
+        else if (arg.starts_with("--rounds="))
+            number_rounds = stoull(string(arg.substr(string_view("--rounds=").size())));
+        else if (arg.starts_with("--output="))
+            output_path = arg.substr(string_view("--output=").size());
+        else
+        {
+            cerr << std::format("Usage: {} [--simulator=PATH] [--topologies=star,ring-uni,ring-bi,hierarchical] "
+                                "[--sizes=10,100,...] [--rounds=N] [--output=FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    auto work_dir = filesystem::temp_directory_path() / std::format("falafels-bench-{}", getpid());
+    filesystem::create_directories(work_dir);
+
+    vector<BenchResult> results;
+
+    for (auto &topology : topologies)
+    {
+        for (auto size : sizes)
+        {
+            auto result = run_simulator(simulator, work_dir, topology, size, number_rounds);
+
+            cerr << std::format("{} with {} trainers: {:.3f} s, {} KB peak RSS, exit status {}\n",
+                                topology, size, result.wall_clock_time, result.peak_rss, result.exit_status);
+
+            results.push_back(result);
+        }
+    }
+
+    filesystem::remove_all(work_dir);
+
+    auto json = to_json(results);
+
+    if (output_path)
+        ofstream(*output_path) << json;
+    else
+        cout << json;
+
+    return 0;
+}
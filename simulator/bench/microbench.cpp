@@ -0,0 +1,239 @@
+/* Microbenchmarks of the per-packet primitives of the simulator */
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <simgrid/s4u/Actor.hpp>
+#include <simgrid/s4u/Engine.hpp>
+#include <simgrid/s4u/Mailbox.hpp>
+#include <string>
+#include <unistd.h>
+#include <vector>
+#include <xbt/log.h>
+
+#include "../src/config_loader.hpp"
+#include "../src/node/mediator/mediator_consumer.hpp"
+#include "../src/node/mediator/mediator_producer.hpp"
+#include "../src/node/network_managers/star_nm.hpp"
+#include "../src/protocol.hpp"
+
+using namespace std;
+using namespace protocol;
+
+/** Number of heap allocations made by the whole process, SimGrid included */
+static atomic<uint64_t> number_allocations = 0;
+
+void *operator new(size_t size)
+{
+    number_allocations.fetch_add(1, memory_order_relaxed);
+
+    if (void *ptr = malloc(size == 0 ? 1 : size))
+        return ptr;
+
+    throw bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+
+/** Largest deployment given to load_config, the platform has one more host for its main aggregator */
+static const uint64_t MAX_NUMBER_TRAINERS = 10000;
+
+/** Measure a batch of operations, printing ns/op and allocations/op */
+static void measure(const string &name, uint64_t number_operations, const function<void()> &batch)
+{
+    uint64_t allocations_before = number_allocations;
+    auto start = chrono::steady_clock::now();
+
+    batch();
+
+    double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+    uint64_t allocations = number_allocations - allocations_before;
+
+    cout << std::format("{:<40} {:>12.1f} ns/op {:>10.2f} allocs/op\n", name, ns / number_operations,
+                        (double) allocations / number_operations);
+}
+
+static void bench_packets(uint64_t n)
+{
+    measure("Packet construction", n, [n]() {
+        for (uint64_t i = 0; i < n; i++)
+            delete new Packet(filters::trainers, operations::SendGlobalModel(1));
+    });
+
+    auto p = make_unique<Packet>("node-1", "node-1", operations::SendLocalModel(1));
+
+    measure("Packet::clone", n, [n, &p]() {
+        for (uint64_t i = 0; i < n; i++)
+            delete p->clone();
+    });
+
+    // Sizes are cached, so a fresh clone is measured each time
+    measure("Packet::clone + get_packet_size", n, [n, &p]() {
+        uint64_t total_size = 0;
+        for (uint64_t i = 0; i < n; i++)
+        {
+            auto clone = p->clone();
+            total_size += clone->get_packet_size();
+            delete clone;
+        }
+        if (total_size == 0) cerr << "unexpected size\n";
+    });
+
+    measure("Packet::get_op_name", n, [n, &p]() {
+        size_t total_length = 0;
+        for (uint64_t i = 0; i < n; i++)
+            total_length += strlen(p->get_op_name());
+        if (total_length == 0) cerr << "unexpected name\n";
+    });
+}
+
+static void bench_send_async(uint64_t n);
+
+/** Round-trips through the MessageQueues of a Mediator, run by a single actor */
+static void bench_mediator(uint64_t n)
+{
+    simgrid::s4u::Actor::create("mediator", simgrid::s4u::Engine::get_instance()->host_by_name("node-0"), [n]() {
+        MediatorConsumer mc("mediator");
+        MediatorProducer mp("mediator");
+
+        measure("Mediator round-trip", n, [n, &mc, &mp]() {
+            for (uint64_t i = 0; i < n; i++)
+            {
+                // Role -> NetworkManager
+                mc.put_async_to_be_sent_packet(filters::trainers, operations::SendGlobalModel(1));
+                auto mess = mp.get_async_to_be_sent_packet();
+                mess->wait();
+                delete (Packet *) mess->get_payload();
+
+                // NetworkManager -> Role
+                mp.put_received_operation(operations::SendLocalModel(1));
+                mc.get_received_operation();
+
+                // Keep the set of pending puts small
+                if (i % 1024 == 0)
+                    mc.wait_all_async_comms();
+            }
+        });
+
+        // Start the next benchmark once we are done, so that they aren't measured at the same time
+        bench_send_async(n);
+    });
+}
+
+/** Packets sent by a NetworkManager to a receiver running on the same host, through its loopback */
+static void bench_send_async(uint64_t n)
+{
+    auto host = simgrid::s4u::Engine::get_instance()->host_by_name("node-0");
+    auto start = make_shared<chrono::steady_clock::time_point>();
+    auto allocations_before = make_shared<uint64_t>();
+
+    simgrid::s4u::Actor::create("sender", host, [n, start, allocations_before]() {
+        StarNetworkManager nm(NodeInfo { .name="sender", .role=NodeRole::MainAggregator });
+        auto p = make_unique<Packet>("receiver", "receiver", operations::SendGlobalModel(1));
+
+        *allocations_before = number_allocations;
+        *start = chrono::steady_clock::now();
+
+        for (uint64_t i = 0; i < n; i++)
+            nm.send_async(p);
+
+        // Wait for the receiver before destroying our pending puts
+        simgrid::s4u::Mailbox::by_name("sender_done")->get<void>();
+    });
+
+    simgrid::s4u::Actor::create("receiver", host, [n, start, allocations_before]() {
+        auto mailbox = simgrid::s4u::Mailbox::by_name("receiver");
+
+        for (uint64_t i = 0; i < n; i++)
+            mailbox->get_unique<Packet>();
+
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - *start).count();
+        uint64_t allocations = number_allocations - *allocations_before;
+
+        cout << std::format("{:<40} {:>12.1f} ns/op {:>10.2f} allocs/op\n", "NetworkManager::send_async", ns / n,
+                            (double) allocations / n);
+
+        simgrid::s4u::Mailbox::by_name("sender_done")->put(nullptr, 0);
+    });
+}
+
+/** Write a star deployment with the given number of trainers on hosts node-1 to node-{number_trainers} */
+static void write_fried(const string &path, uint64_t number_trainers)
+{
+    ofstream file(path);
+
+    file << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<fried version=\"0.1\">\n";
+    file << "    <constants>\n        <constant name=\"END_CONDITION_NUMBER_ROUNDS\" value=\"1\"/>\n    </constants>\n";
+    file << "    <cluster topology=\"star\">\n";
+
+    for (uint64_t i = 1; i <= number_trainers; i++)
+    {
+        file << std::format("        <node name=\"node-{}\">\n            <trainer type=\"simple\"/>\n", i);
+        file << "            <network-manager>\n";
+        file << "                <arg name=\"bootstrap-node\" value=\"node-0\"/>\n";
+        file << "            </network-manager>\n        </node>\n";
+    }
+
+    file << "        <node name=\"node-0\">\n            <aggregator type=\"simple\">\n";
+    file << "                <arg name=\"is_main_aggregator\" value=\"1\"/>\n";
+    file << "            </aggregator>\n            <network-manager/>\n        </node>\n";
+    file << "    </cluster>\n</fried>\n";
+}
+
+/** Nodes aren't deleted, their Roles and NetworkManagers being only freed by their actors */
+static void bench_load_config(const filesystem::path &work_dir)
+{
+    for (uint64_t number_trainers = 10; number_trainers <= MAX_NUMBER_TRAINERS; number_trainers *= 10)
+    {
+        auto path = work_dir / std::format("fried-{}.xml", number_trainers);
+        write_fried(path, number_trainers);
+
+        measure(std::format("load_config ({} trainers, per node)", number_trainers), number_trainers + 1, [&path]() {
+            delete load_config(path.c_str());
+        });
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    simgrid::s4u::Engine e(&argc, argv);
+
+    // Logs would be most of what is measured
+    xbt_log_control_set("root.thres:critical");
+
+    uint64_t n = argc > 1 ? stoull(argv[1]) : 100000;
+
+    auto work_dir = filesystem::temp_directory_path() / std::format("falafels-microbench-{}", getpid());
+    filesystem::create_directories(work_dir);
+
+    // A single cluster keeps the platform linear in the number of hosts
+    auto platform_path = work_dir / "platform.xml";
+    ofstream(platform_path) << std::format(
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<!DOCTYPE platform SYSTEM \"https://simgrid.org/simgrid.dtd\">\n"
+        "<platform version=\"4.1\">\n"
+        "    <cluster id=\"bench\" prefix=\"node-\" suffix=\"\" radical=\"0-{}\" speed=\"1Gf\" bw=\"1.25GBps\" lat=\"50us\"/>\n"
+        "</platform>\n", MAX_NUMBER_TRAINERS
+    );
+
+    e.load_platform(platform_path.string());
+
+    bench_packets(n);
+    bench_load_config(work_dir);
+
+    // Needs the engine to run, and starts the send_async benchmark once done
+    bench_mediator(n);
+    e.run();
+
+    filesystem::remove_all(work_dir);
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+# Run at build time to write FALAFELS_VERSION to OUTPUT, only touching it when the version changed so that
+# unchanged builds aren't recompiled
+execute_process(
+    COMMAND git describe --always --dirty
+    WORKING_DIRECTORY ${SOURCE_DIR}
+    OUTPUT_VARIABLE FALAFELS_GIT_DESCRIBE
+    OUTPUT_STRIP_TRAILING_WHITESPACE
+    ERROR_QUIET
+)
+
+file(WRITE ${OUTPUT}.tmp "#define FALAFELS_VERSION \"${PROJECT_VERSION}-${FALAFELS_GIT_DESCRIBE}\"\n")
+configure_file(${OUTPUT}.tmp ${OUTPUT} COPYONLY)
+file(REMOVE ${OUTPUT}.tmp)
@@ -0,0 +1,87 @@
+#include <format>
+#include <random>
+#include <simgrid/kernel/ProfileBuilder.hpp>
+#include <simgrid/s4u/Engine.hpp>
+#include <simgrid/s4u/Host.hpp>
+#include <sstream>
+#include <xbt/asserts.h>
+#include <xbt/log.h>
+
+#include "churn.hpp"
+#include "constants.hpp"
+#include "node/node.hpp"
+#include "utils/utils.hpp"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_churn, "Messages specific for this example");
+
+using namespace std;
+using namespace protocol;
+
+/** Number of failures drawn per host, the profile then repeats itself */
+static const int NUMBER_DRAWN_FAILURES = 32;
+
+ChurnInjector::ChurnInjector()
+{
+    simgrid::s4u::Host::on_onoff_cb([this](simgrid::s4u::Host const &host) { this->on_host_state_change(host); });
+}
+
+void ChurnInjector::add_trainer(const node_name &name, function<Node*()> respawn)
+{
+    xbt_assert(!Constants::SYMMETRY_REDUCTION, "Churn cannot be combined with SYMMETRY_REDUCTION");
+
+    this->respawns[name] = respawn;
+
+    if (Constants::CHURN_MEAN_TIME_TO_FAILURE != 0.0)
+        this->set_random_state_profile(simgrid::s4u::Engine::get_instance()->host_by_name(name));
+}
+
+void ChurnInjector::set_random_state_profile(simgrid::s4u::Host *host)
+{
+    xbt_assert(Constants::CHURN_MEAN_TIME_TO_RECOVERY > 0.0, "CHURN_MEAN_TIME_TO_RECOVERY should be defined");
+
+    auto generator = create_named_generator(Constants::CHURN_SEED, host->get_name());
+
+    exponential_distribution<double> time_to_failure(1.0 / Constants::CHURN_MEAN_TIME_TO_FAILURE);
+    exponential_distribution<double> time_to_recovery(1.0 / Constants::CHURN_MEAN_TIME_TO_RECOVERY);
+
+    // Dates of the state changes, 0 meaning off and 1 on
+    stringstream trace;
+    double date = 0.0;
+
+    for (int i = 0; i < NUMBER_DRAWN_FAILURES; i++)
+    {
+        date += time_to_failure(generator);
+        trace << date << " 0\n";
+
+        date += time_to_recovery(generator);
+        trace << date << " 1\n";
+    }
+
+    auto profile = simgrid::kernel::profile::ProfileBuilder::from_string(
+        std::format("{}_churn", host->get_name()), trace.str(), time_to_failure(generator)
+    );
+
+    host->set_state_profile(profile);
+}
+
+void ChurnInjector::on_host_state_change(simgrid::s4u::Host const &host)
+{
+    auto respawn = this->respawns.find(host.get_name());
+
+    if (respawn == this->respawns.end())
+        return;
+
+    if (!host.is_on())
+    {
+        // The actors of the host are killed by SimGrid
+        XBT_INFO("Host %s failed", host.get_cname());
+        return;
+    }
+
+    XBT_INFO("Host %s recovered, its Node joins again", host.get_cname());
+
+    // The Node may rejoin after the end of the training, so it shouldn't keep the simulation running
+    Node *node = respawn->second();
+    node->run(true);
+    delete node;
+}
@@ -0,0 +1,45 @@
+#ifndef FALAFELS_CHURN_HPP
+#define FALAFELS_CHURN_HPP
+
+#include <functional>
+#include <simgrid/forward.h>
+#include <unordered_map>
+
+#include "protocol.hpp"
+
+class Node;
+
+/**
+ * Singleton bringing trainers of star clusters back when their host recovers from a failure, see
+ * Constants::CHURN_HEARTBEAT_PERIOD. Hosts fail either with the state profile (`state_file`) of the platform, or with
+ * the random failure and recovery process drawn here when CHURN_MEAN_TIME_TO_FAILURE is set.
+ * A failing host kills the actors of its Node, which is created again, as described in the fried file, once the host
+ * is back on. The new Node registers to its aggregator as if it was joining the cluster.
+ */
+class ChurnInjector
+{
+public:
+    static ChurnInjector& get_instance()
+    {
+        static ChurnInjector instance;
+        return instance;
+    }
+
+    ChurnInjector(ChurnInjector const&) = delete;
+    void operator=(ChurnInjector const&) = delete;
+
+    /** Register a trainer subject to churn, respawn creating a new Node for it. Only called while loading the deployment */
+    void add_trainer(const protocol::node_name &name, std::function<Node*()> respawn);
+private:
+    ChurnInjector();
+
+    /** Draw the failures and recoveries of a host, deterministic for a given CHURN_SEED */
+    void set_random_state_profile(simgrid::s4u::Host *host);
+
+    /** Called whenever a host is turned on or off */
+    void on_host_state_change(simgrid::s4u::Host const &host);
+
+    std::unordered_map<std::string, std::function<Node*()>> respawns;
+};
+
+#endif // !FALAFELS_CHURN_HPP
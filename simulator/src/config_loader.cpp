@@ -1,6 +1,15 @@
 #include <cstring>
+#include <format>
+#include <iomanip>
+#include <map>
 #include <memory>
+#include <simgrid/s4u/Disk.hpp>
+#include <simgrid/s4u/Engine.hpp>
+#include <simgrid/s4u/Host.hpp>
+#include <simgrid/s4u/Link.hpp>
+#include <sstream>
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 #include <xbt/asserts.h>
@@ -18,9 +27,12 @@
 #include "node/network_managers/ring_uni_nm.hpp"
 #include "node/network_managers/hierarchical_nm.hpp"
 // #include "node/network_managers/full_nm.hpp"
+#include "churn.hpp"
 #include "config_loader.hpp"
 #include "constants.hpp"
 #include "protocol.hpp"
+#include "symmetry.hpp"
+#include "trace_profile.hpp"
 #include "utils/utils.hpp"
  
  
@@ -153,17 +165,27 @@ Role *create_role(xml_node *role_elem, node_name name)
  * @param node_elem XML element that contains node informations.
  * @param name The name of the current node.
  * @param topology Topology used in the Node's network.
+ * @param constants Constants of the cluster of the Node.
+ * @param multiplicity Number of equivalent trainers simulated by this node, see Constants::SYMMETRY_REDUCTION.
  * @return A pointer to the created Node.
  */
-Node *create_node(xml_node *node_elem, node_name name, string topology)
+Node *create_node(xml_node *node_elem, node_name name, string topology, shared_ptr<const ClusterConstants> constants,
+                  uint32_t multiplicity=1)
 {
     XBT_INFO("------------------------------");
     XBT_INFO("Creating node: %s", name.c_str());
 
     xml_node role_elem = node_elem->first_child();
     Role *role = create_role(&role_elem, name);
+    role->set_constants(constants);
 
-    NodeInfo node_info = NodeInfo { .name = name, .role=role->get_role_type() };
+    if (multiplicity > 1)
+    {
+        XBT_INFO("Representing %u trainers", multiplicity);
+        static_cast<Trainer*>(role)->set_multiplicity(multiplicity);
+    }
+
+    NodeInfo node_info = NodeInfo { .name = name, .role=role->get_role_type(), .multiplicity=multiplicity };
 
     xml_node network_manager_elem = role_elem.next_sibling(); 
     auto network_manager = create_network_manager(&network_manager_elem, node_info, topology);
@@ -172,30 +194,408 @@ Node *create_node(xml_node *node_elem, node_name name, string topology)
     return new Node(role, network_manager);
 }
 
+/** 
+ * Whether a profile applying to a trainer gives it values of its own: random walks are drawn from the name of their
+ * resource, unless it is a link named by the profile, shared by every trainer the profile applies to.
+ */
+bool is_trainer_specific(xml_node profile_elem)
+{
+    bool named_link = profile_elem.attribute("link") && strcmp(profile_elem.attribute("target").as_string(), "speed") != 0;
+
+    return depends_on_resource_name(profile_elem) && !named_link;
+}
+
+/**
+ * Compute a string that is equal for trainers that behave the same way in the simulation: same host profile and disks,
+ * same route characteristics to their bootstrap node, and same arguments.
+ * @param node_elem XML element of a trainer node.
+ * @return The signature of the trainer.
+ */
+string get_trainer_signature(xml_node *node_elem)
+{
+    auto e = simgrid::s4u::Engine::get_instance();
+    auto host = e->host_by_name(node_elem->attribute("name").as_string());
+
+    stringstream signature;
+    // Resources differing beyond the default 6 significant digits shouldn't be grouped
+    signature << setprecision(17);
+
+    // Host profile
+    signature << host->get_speed() << ';' << host->get_core_count() << ';' << host->get_pstate() << ';';
+
+    map<string, string> properties(host->get_properties()->begin(), host->get_properties()->end());
+    for (auto &[key, value]: properties)
+        signature << key << '=' << value << ';';
+
+    // Disks the datasets are read from, whatever their names
+    for (auto disk: host->get_disks())
+    {
+        signature << disk->get_read_bandwidth() << ',' << disk->get_write_bandwidth() << ',';
+
+        map<string, string> disk_properties(disk->get_properties()->begin(), disk->get_properties()->end());
+        for (auto &[key, value]: disk_properties)
+            signature << key << '=' << value << ',';
+
+        signature << ';';
+    }
+
+    // Route to the bootstrap node
+    auto network_manager_elem = node_elem->child("network-manager");
+
+    for (xml_node arg: network_manager_elem.children())
+    {
+        if (strcmp(arg.attribute("name").as_string(), "bootstrap-node") != 0)
+            continue;
+
+        vector<simgrid::s4u::Link*> links;
+        double latency = 0.0;
+        host->route_to(e->host_by_name(arg.attribute("value").as_string()), links, &latency);
+
+        signature << latency << ';';
+
+        for (auto link: links)
+        {
+            auto wattage_range = link->get_property("wattage_range");
+
+            signature << link->get_bandwidth() << ',' << link->get_latency() << ','
+                      << (int)link->get_sharing_policy() << ',' << (wattage_range ? wattage_range : "") << ';';
+        }
+    }
+
+    // Role and NetworkManager arguments, the bootstrap node being included on purpose
+    node_elem->first_child().print(signature, "", format_raw);
+    network_manager_elem.print(signature, "", format_raw);
+
+    // Profiles of the links and host. The ones of the cluster apply to every trainer, but their random walks differ.
+    bool trainer_specific = false;
+
+    for (xml_node profile_elem: node_elem->children("profile"))
+    {
+        profile_elem.print(signature, "", format_raw);
+        trainer_specific = trainer_specific || is_trainer_specific(profile_elem);
+    }
+
+    for (xml_node profile_elem: node_elem->parent().children("profile"))
+        trainer_specific = trainer_specific || is_trainer_specific(profile_elem);
+
+    if (trainer_specific)
+        signature << node_elem->attribute("name").as_string() << ';';
+
+    return signature.str();
+}
+
+/**
+ * Group the trainers of a star cluster into classes of equivalent trainers, see Constants::SYMMETRY_REDUCTION.
+ * @param nodes_elem XML element that contains the list of nodes.
+ * @return An unordered map pairing the representative of each class with the other trainers of its class.
+ */
+unordered_map<node_name, vector<node_name>> find_equivalent_trainers(xml_node *nodes_elem)
+{
+    unordered_map<string, node_name> representatives;
+    unordered_map<node_name, vector<node_name>> classes;
+
+    for (xml_node node_elem: nodes_elem->children("node"))
+    {
+        if (strcmp(node_elem.first_child().name(), "trainer") != 0)
+            continue;
+
+        node_name name = node_elem.attribute("name").as_string();
+        auto signature = get_trainer_signature(&node_elem);
+
+        // The first trainer of a class represents it
+        if (auto representative = representatives.find(signature); representative != representatives.end())
+            classes.at(representative->second).push_back(name);
+        else
+        {
+            representatives.insert({ signature, name });
+            classes.insert({ name, vector<node_name>() });
+        }
+    }
+
+    return classes;
+}
+
+/**
+ * Read the constants of a cluster: the global ones, overridden by the <constants> element of the cluster if any.
+ * @param cluster_elem XML element of the cluster.
+ * @return The constants shared by the Roles of the cluster.
+ */
+shared_ptr<const ClusterConstants> init_cluster_constants(xml_node *cluster_elem)
+{
+    auto constants = make_shared<ClusterConstants>();
+
+    for (xml_node constant: cluster_elem->child("constants").children())
+    {
+        xml_attribute name = constant.attribute("name");
+        xml_attribute value = constant.attribute("value");
+
+        // If the value is empty ingore constant
+        if (value.empty())
+            continue;
+
+        XBT_INFO("Set %s=%s for this cluster", name.as_string(), value.as_string());
+
+        switch (str2int(name.as_string())) {
+            case str2int("MODEL_SIZE_BYTES"):
+                constants->MODEL_SIZE_BYTES = value.as_ullong();
+                break;
+            case str2int("GLOBAL_MODEL_AGGREGATING_FLOPS"):
+                constants->GLOBAL_MODEL_AGGREGATING_FLOPS = value.as_double();
+                break;
+            case str2int("LOCAL_MODEL_TRAINING_FLOPS"):
+                constants->LOCAL_MODEL_TRAINING_FLOPS = value.as_double();
+                break;
+            case str2int("REFERENCE_DATASET_SIZE"):
+                constants->REFERENCE_DATASET_SIZE = value.as_ullong();
+                break;
+            case str2int("DATASET_SAMPLE_SIZE_BYTES"):
+                constants->DATASET_SAMPLE_SIZE_BYTES = value.as_ullong();
+                break;
+            case str2int("END_CONDITION_DURATION_TRAINING_PHASE"):
+                constants->END_CONDITION_DURATION_TRAINING_PHASE = value.as_double();
+                break;
+            case str2int("END_CONDITION_NUMBER_ROUNDS"):
+                constants->END_CONDITION_NUMBER_ROUNDS = value.as_ullong();
+                break;
+            case str2int("END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS"):
+                constants->END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS = value.as_ullong();
+                break;
+            case str2int("END_CONDITION_TARGET_ACCURACY"):
+                constants->END_CONDITION_TARGET_ACCURACY = value.as_double();
+                break;
+            // END_CONDITION_ENERGY_BUDGET is only global: the consumption it is compared to is the one of the whole
+            // platform, which clusters share
+            default:
+                xbt_die("%s cannot be set per cluster", name.as_string());
+        }
+    }
+
+    xbt_assert(constants->END_CONDITION_TARGET_ACCURACY < Constants::CONVERGENCE_MAX_ACCURACY,
+               "END_CONDITION_TARGET_ACCURACY %f of the cluster can never be reached, CONVERGENCE_MAX_ACCURACY being %f",
+               constants->END_CONDITION_TARGET_ACCURACY, Constants::CONVERGENCE_MAX_ACCURACY);
+
+    return constants;
+}
+
+vector<simgrid::s4u::Link*> get_access_links(xml_node *node_elem)
+{
+    auto e = simgrid::s4u::Engine::get_instance();
+    node_name name = node_elem->attribute("name").as_string();
+
+    for (xml_node arg: node_elem->child("network-manager").children())
+    {
+        if (strcmp(arg.attribute("name").as_string(), "bootstrap-node") != 0)
+            continue;
+
+        auto host = e->host_by_name(name);
+        auto bootstrap_host = e->host_by_name(arg.attribute("value").as_string());
+
+        vector<simgrid::s4u::Link*> route, route_back;
+        double latency = 0.0;
+
+        host->route_to(bootstrap_host, route, &latency);
+        bootstrap_host->route_to(host, route_back, &latency);
+
+        xbt_assert(!route.empty() && !route_back.empty(), "%s has no link to its bootstrap node", name.c_str());
+
+        if (route.front() == route_back.back())
+            return { route.front() };
+
+        return { route.front(), route_back.back() };
+    }
+
+    xbt_die("%s has no bootstrap node, its profiles should name their link", name.c_str());
+}
+
+/** A <profile> element resolved to the resource it is attached to */
+struct ResolvedProfile
+{
+    xml_node profile_elem;
+    string target;
+    simgrid::s4u::Host *host = nullptr;
+    simgrid::s4u::Link *link = nullptr;
+};
+
+/**
+ * Resolve a <profile> element to the resources it targets:
+ * - speed: the host of the node.
+ * - bandwidth, latency: the link named by its `link` attribute, or the access links of the node.
+ * @param profile_elem XML element of the profile.
+ * @param node_elem XML element of the node the profile applies to, only needed without a `link` attribute.
+ * @param profiles Resolved profiles, keyed by resource and target, which are replaced if already there.
+ */
+void resolve_profile(xml_node profile_elem, xml_node *node_elem, map<string, ResolvedProfile> *profiles)
+{
+    auto e = simgrid::s4u::Engine::get_instance();
+    string target = profile_elem.attribute("target").as_string();
+
+    if (target == "speed")
+    {
+        auto host = e->host_by_name(node_elem->attribute("name").as_string());
+        (*profiles)[std::format("{}_speed", host->get_name())] = ResolvedProfile { .profile_elem = profile_elem, .target = target, .host = host };
+        return;
+    }
+
+    xbt_assert(target == "bandwidth" || target == "latency",
+               "Unknown profile target '%s', should be speed, bandwidth or latency", target.c_str());
+
+    vector<simgrid::s4u::Link*> links;
+
+    if (auto link_name = profile_elem.attribute("link"))
+        links.push_back(e->link_by_name(link_name.as_string()));
+    else
+        links = get_access_links(node_elem);
+
+    for (auto link: links)
+        (*profiles)[std::format("{}_{}", link->get_name(), target)] = ResolvedProfile { .profile_elem = profile_elem, .target = target, .link = link };
+}
+
+/**
+ * Attach the <profile> elements of the nodes of a cluster, and the ones of the cluster itself, to the resources they
+ * target, see resolve_profile(). Profiles of the cluster apply to each of its trainers, unless they name their link.
+ * A resource only gets one profile per target, the ones of a node overriding the ones of its cluster.
+ * @param nodes_elem XML element of the cluster.
+ * @param profiled_resources Resources that already got a profile from the previous clusters.
+ */
+void apply_profiles(xml_node *nodes_elem, unordered_set<string> *profiled_resources)
+{
+    map<string, ResolvedProfile> profiles;
+
+    for (xml_node profile_elem: nodes_elem->children("profile"))
+    {
+        if (profile_elem.attribute("link") && strcmp(profile_elem.attribute("target").as_string(), "speed") != 0)
+        {
+            resolve_profile(profile_elem, nullptr, &profiles);
+            continue;
+        }
+
+        // Aggregators have no bootstrap node to find their access links, and their hosts are dedicated
+        for (xml_node node_elem: nodes_elem->children("node"))
+        {
+            if (strcmp(node_elem.first_child().name(), "trainer") == 0)
+                resolve_profile(profile_elem, &node_elem, &profiles);
+        }
+    }
+
+    for (xml_node node_elem: nodes_elem->children("node"))
+    {
+        for (xml_node profile_elem: node_elem.children("profile"))
+            resolve_profile(profile_elem, &node_elem, &profiles);
+    }
+
+    for (auto &[name, profile]: profiles)
+    {
+        // SimGrid doesn't allow replacing the profile of a resource
+        xbt_assert(profiled_resources->insert(name).second, "Several clusters set the profile %s", name.c_str());
+
+        switch (str2int(profile.target.c_str()))
+        {
+            case str2int("speed"):
+                // Values of speed profiles are fractions of the peak speed of the host
+                profile.host->set_speed_profile(create_trace_profile(profile.profile_elem, name, 1.0, true));
+                break;
+            case str2int("bandwidth"):
+                profile.link->set_bandwidth_profile(
+                    create_trace_profile(profile.profile_elem, name, profile.link->get_bandwidth(), true)
+                );
+                break;
+            case str2int("latency"):
+                profile.link->set_latency_profile(create_trace_profile(profile.profile_elem, name, profile.link->get_latency()));
+                break;
+        }
+    }
+}
+
+/**
+ * Let a trainer fail and come back, see ChurnInjector. The trainer is created again from a copy of its XML element, 
+ * because the document is freed once loaded.
+ * @param node_elem XML element of the trainer.
+ * @param topology Topology used in the Node's network.
+ * @param constants Constants of the cluster of the Node.
+ * @param bootstrap_nodes Bootstrap nodes of the trainer.
+ */
+void add_churning_trainer(xml_node *node_elem, string topology, shared_ptr<const ClusterConstants> constants,
+                          const vector<NodeInfo> &bootstrap_nodes)
+{
+    node_name name = node_elem->attribute("name").as_string();
+
+    stringstream node_xml;
+    node_elem->print(node_xml, "", format_raw);
+
+    ChurnInjector::get_instance().add_trainer(
+        name,
+        [name, node_xml=node_xml.str(), topology, constants, bootstrap_nodes]()
+        {
+            xml_document doc;
+            doc.load_string(node_xml.c_str());
+
+            xml_node node_elem = doc.first_child();
+            Node *node = create_node(&node_elem, name, topology, constants);
+            node->set_bootstrap_nodes(new vector<NodeInfo>(bootstrap_nodes));
+
+            return node;
+        }
+    );
+}
+
 /**
  * Create nodes with their respectful configuration and updates the unordered map.
  * @param An unordered map with node_name as key and a pointer to the given Node.
  * @param nodes_elem XML element that contains the list of nodes.
+ * @param profiled_resources Resources that got a profile from the previous clusters, see apply_profiles().
  */
-void create_nodes(unordered_map<node_name, Node*> *nodes_map, xml_node *nodes_elem)
+void create_nodes(unordered_map<node_name, Node*> *nodes_map, xml_node *nodes_elem, unordered_set<string> *profiled_resources)
 {
     XBT_INFO("Creating falafels nodes...");
 
     string topology = nodes_elem->attribute("topology").as_string();
+    auto constants = init_cluster_constants(nodes_elem);
+
+    xbt_assert(Constants::CHURN_MEAN_TIME_TO_FAILURE == 0.0 || Constants::CHURN_HEARTBEAT_PERIOD != 0.0,
+               "CHURN_MEAN_TIME_TO_FAILURE needs CHURN_HEARTBEAT_PERIOD to be defined");
+
+    // Trainers that are not representatives of their class are only simulated through their representative
+    unordered_set<node_name> shadows;
+    unordered_map<node_name, vector<node_name>> classes;
+
+    if (Constants::SYMMETRY_REDUCTION && topology == "star")
+    {
+        classes = find_equivalent_trainers(nodes_elem);
+
+        for (auto &[representative, others]: classes)
+        {
+            if (others.empty())
+                continue;
+
+            SymmetryReduction::get_instance().add_class(representative, others);
+            shadows.insert(others.begin(), others.end());
+        }
+    }
 
     // Loop through each (xml) node of the document to instanciate (simulated) nodes
     for (xml_node node_elem: nodes_elem->children("node"))
     {
         node_name name = node_elem.attribute("name").as_string();
-        Node *node = create_node(&node_elem, name, topology);
+
+        if (shadows.contains(name))
+            continue;
+
+        uint32_t multiplicity = classes.contains(name) ? classes.at(name).size() + 1 : 1;
+        Node *node = create_node(&node_elem, name, topology, constants, multiplicity);
 
         nodes_map->insert({name, node});
     }
 
+    // Shadows transfer through their own links
+    apply_profiles(nodes_elem, profiled_resources);
+
     // Loop a second time to set boostrap nodes
     for (xml_node node_elem: nodes_elem->children("node"))
     {
         node_name name = node_elem.attribute("name").as_string();
+
+        if (shadows.contains(name))
+            continue;
         auto bootstrap_nodes = new vector<NodeInfo>(); 
 
         // Loop through bootstrap nodes
@@ -216,6 +616,13 @@ void create_nodes(unordered_map<node_name, Node*> *nodes_map, xml_node *nodes_el
 
         // Set boostrap nodes
         nodes_map->at(name)->set_bootstrap_nodes(bootstrap_nodes); 
+
+        // Only aggregators of star clusters notice the departure of their trainers
+        if (Constants::CHURN_HEARTBEAT_PERIOD != 0.0 && topology == "star"
+            && strcmp(node_elem.first_child().name(), "trainer") == 0)
+        {
+            add_churning_trainer(&node_elem, topology, constants, *bootstrap_nodes);
+        }
     }
 }
 
@@ -230,6 +637,8 @@ void set_constant(const xml_attribute *name, xml_attribute *value)
     if (value->empty())
         return;
 
+    xbt_assert(!Constants::is_frozen(), "Constants cannot be changed once the simulation has been set up");
+
     XBT_INFO("Set %s=%s", name->as_string(), value->as_string());
 
     switch (str2int(name->as_string())) {
@@ -242,6 +651,51 @@ void set_constant(const xml_attribute *name, xml_attribute *value)
         case str2int("LOCAL_MODEL_TRAINING_FLOPS"):
             Constants::LOCAL_MODEL_TRAINING_FLOPS = value->as_double();
             break;
+        case str2int("REFERENCE_DATASET_SIZE"):
+            Constants::REFERENCE_DATASET_SIZE = value->as_ullong();
+            break;
+        case str2int("DATASET_SAMPLE_SIZE_BYTES"):
+            Constants::DATASET_SAMPLE_SIZE_BYTES = value->as_ullong();
+            break;
+        case str2int("DATASET_PAGE_CACHE"):
+            Constants::DATASET_PAGE_CACHE = value->as_bool();
+            break;
+        case str2int("CHURN_HEARTBEAT_PERIOD"):
+            Constants::CHURN_HEARTBEAT_PERIOD = value->as_double();
+            break;
+        case str2int("CHURN_MEAN_TIME_TO_FAILURE"):
+            Constants::CHURN_MEAN_TIME_TO_FAILURE = value->as_double();
+            break;
+        case str2int("CHURN_MEAN_TIME_TO_RECOVERY"):
+            Constants::CHURN_MEAN_TIME_TO_RECOVERY = value->as_double();
+            break;
+        case str2int("CHURN_SEED"):
+            Constants::CHURN_SEED = value->as_ullong();
+            break;
+        case str2int("MODEL_CHUNK_SIZE_BYTES"):
+            Constants::MODEL_CHUNK_SIZE_BYTES = value->as_ullong();
+            break;
+        case str2int("RING_ORDER_BY_LATENCY"):
+            Constants::RING_ORDER_BY_LATENCY = value->as_bool();
+            break;
+        case str2int("DVFS_LEARNING_ROUNDS"):
+            Constants::DVFS_LEARNING_ROUNDS = value->as_ullong();
+            break;
+        case str2int("TRAINER_SLEEP_PSTATE"):
+            Constants::TRAINER_SLEEP_PSTATE = value->as_llong();
+            break;
+        case str2int("TRAINER_WAKEUP_LATENCY"):
+            Constants::TRAINER_WAKEUP_LATENCY = value->as_double();
+            break;
+        case str2int("TRAINER_WAKEUP_ENERGY"):
+            Constants::TRAINER_WAKEUP_ENERGY = value->as_double();
+            break;
+        case str2int("SYMMETRY_REDUCTION"):
+            Constants::SYMMETRY_REDUCTION = value->as_bool();
+            break;
+        case str2int("FUSE_NODE_ACTORS"):
+            Constants::FUSE_NODE_ACTORS = value->as_bool();
+            break;
         case str2int("REGISTRATION_TIMEOUT"):
             Constants::REGISTRATION_TIMEOUT = value->as_double();
             break;
@@ -254,6 +708,39 @@ void set_constant(const xml_attribute *name, xml_attribute *value)
         case str2int("END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS"):
             Constants::END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS = value->as_int();
             break;
+        case str2int("END_CONDITION_TARGET_ACCURACY"):
+            Constants::END_CONDITION_TARGET_ACCURACY = value->as_double();
+            break;
+        case str2int("END_CONDITION_ENERGY_BUDGET"):
+            Constants::END_CONDITION_ENERGY_BUDGET = value->as_double();
+            break;
+        case str2int("CONVERGENCE_CURVE"):
+            Constants::CONVERGENCE_CURVE = value->as_string();
+            break;
+        case str2int("CONVERGENCE_MAX_ACCURACY"):
+            Constants::CONVERGENCE_MAX_ACCURACY = value->as_double();
+            break;
+        case str2int("CONVERGENCE_EPOCHS_SCALE"):
+            Constants::CONVERGENCE_EPOCHS_SCALE = value->as_double();
+            break;
+        case str2int("CONVERGENCE_POWER"):
+            Constants::CONVERGENCE_POWER = value->as_double();
+            break;
+        case str2int("CONVERGENCE_STALENESS_PENALTY"):
+            Constants::CONVERGENCE_STALENESS_PENALTY = value->as_double();
+            break;
+        case str2int("CONVERGENCE_SAMPLING_PENALTY"):
+            Constants::CONVERGENCE_SAMPLING_PENALTY = value->as_double();
+            break;
+        case str2int("CONVERGENCE_COMPRESSION_PENALTY"):
+            Constants::CONVERGENCE_COMPRESSION_PENALTY = value->as_double();
+            break;
+        case str2int("STEADY_STATE_ROUNDS"):
+            Constants::STEADY_STATE_ROUNDS = value->as_ullong();
+            break;
+        case str2int("STEADY_STATE_TOLERANCE"):
+            Constants::STEADY_STATE_TOLERANCE = value->as_double();
+            break;
         }
 }
 
@@ -272,6 +759,11 @@ void init_constants(xml_node *constants_elem)
         set_constant(&name, &value);
     }
 
+    // The accuracy only approaches its maximum, without STEADY_STATE_ROUNDS the simulation would never end
+    xbt_assert(Constants::END_CONDITION_TARGET_ACCURACY < Constants::CONVERGENCE_MAX_ACCURACY,
+               "END_CONDITION_TARGET_ACCURACY %f can never be reached, CONVERGENCE_MAX_ACCURACY being %f",
+               Constants::END_CONDITION_TARGET_ACCURACY, Constants::CONVERGENCE_MAX_ACCURACY);
+
     XBT_INFO("-------------------------");
 }
 
@@ -280,6 +772,17 @@ void init_constants(xml_node *constants_elem)
  * @param file path to the fried falafels deployment file.
  * @return A map pairing each created node pointer with its name as a key
  */
+void load_constants(const char* file_path)
+{
+    xml_document doc;
+    xml_parse_result result = doc.load_file(file_path);
+
+    xbt_assert(result != 0, "Error while loading fried falafels deployment file");
+
+    xml_node constants_elem = doc.child("fried").child("constants");
+    init_constants(&constants_elem);
+}
+
 unordered_map<node_name, Node*> *load_config(const char* file_path)
 {
     xml_document doc;
@@ -294,10 +797,11 @@ unordered_map<node_name, Node*> *load_config(const char* file_path)
     init_constants(&constants_elem);
 
     auto nodes_map = new unordered_map<node_name, Node*>();
+    unordered_set<string> profiled_resources;
 
     for (auto cluster: clusters_elem)
     {
-        create_nodes(nodes_map, &cluster);
+        create_nodes(nodes_map, &cluster, &profiled_resources);
     }
     return nodes_map; 
 }
@@ -2,7 +2,10 @@
 #define FALAFELS_CONFIG_LOADER_HPP
 
 #include <memory>
+#include <pugixml.hpp>
+#include <simgrid/forward.h>
 #include <unordered_map>
+#include <vector>
 #include "node/node.hpp"
 #include "protocol.hpp"
 
@@ -15,4 +18,19 @@
  */
 std::unordered_map<protocol::node_name, Node*> *load_config(const char* file_path);
 
+/**
+ * Only initialize the constants of a fried falafels deployment file, without creating any node.
+ *
+ * @param file path to the fried falafels deployment file.
+ */
+void load_constants(const char* file_path);
+
+/**
+ * Get the links connecting a node to the rest of the platform: the first link of the route to its first bootstrap
+ * node and the last one of the route back, which are the same with shared links.
+ * @param node_elem XML element of the node.
+ * @return The links of the node.
+ */
+std::vector<simgrid::s4u::Link*> get_access_links(pugi::xml_node *node_elem);
+
 #endif // !FALAFELS_CONFIG_LOADER_HPP
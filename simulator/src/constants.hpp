@@ -2,6 +2,7 @@
 #define CONSTANTS_HPP
 
 #include <cstdint>
+#include <string>
 
 /**
  * Class storing global constants that can are used in the whole program.
@@ -20,9 +21,82 @@ public:
     /** Number of flops for training a local model. */
     inline static double LOCAL_MODEL_TRAINING_FLOPS = 1000000.0;
 
+    /** 
+     * Number of samples LOCAL_MODEL_TRAINING_FLOPS is the training cost of, trainers with a `dataset_size` argument
+     * scaling their cost accordingly. Trainers without one have this many samples.
+     */
+    inline static uint64_t REFERENCE_DATASET_SIZE = 1;
+
+    /** 
+     * Size of a sample of the dataset, trainers reading their shard (dataset_size samples) from the first disk of their
+     * host before each epoch. 0 when the datasets aren't read, trainers can also set their `shard_size_bytes`.
+     */
+    inline static uint64_t DATASET_SAMPLE_SIZE_BYTES = 0;
+
+    /** 
+     * Whether shards stay in the page cache of their host once read, so that only the first epoch of the simulation
+     * reads the disk. Otherwise the shard is read before every epoch.
+     */
+    inline static bool DATASET_PAGE_CACHE = true;
+
     /** Timeout for the registration phase */
     inline static double REGISTRATION_TIMEOUT = 4.0;
 
+    /** 
+     * Size of the chunks model packets are split into when relayed along a ring, so that each relay forwards a chunk
+     * as soon as it arrives (cut-through forwarding). 0 when the feature isn't used.
+     */
+    inline static uint64_t MODEL_CHUNK_SIZE_BYTES = 0;
+
+    /** 
+     * Order the trainers of rings by following the routes of least latency from the main aggregator, instead of
+     * their order of arrival, so that models travel around the ring as fast as possible.
+     */
+    inline static bool RING_ORDER_BY_LATENCY = false;
+
+    /** 
+     * Run the Role and the NetworkManager of each Node in a single actor instead of two, handing operations and
+     * events over in memory. Halves the number of actors and the context switches per received packet.
+     */
+    inline static bool FUSE_NODE_ACTORS = false;
+
+    /** 
+     * Only simulate one trainer per class of equivalent trainers in star clusters, i.e. trainers with the same host
+     * profile, route to their aggregator and arguments. It is counted as many local models as its class has trainers,
+     * and its transfers are mirrored to the hosts of the others so that link sharing stays the same.
+     */
+    inline static bool SYMMETRY_REDUCTION = false;
+
+    /** 
+     * Number of rounds over which synchronous aggregators learn the training time and slack of their trainers, before
+     * setting each trainer host to the pstate that saves the most energy without delaying rounds. 0 when the feature
+     * isn't used.
+     */
+    inline static uint64_t DVFS_LEARNING_ROUNDS = 0;
+
+    /** 
+     * Pstate trainer hosts switch to while waiting for the global model, -1 when trainers stay awake. Waking up takes
+     * TRAINER_WAKEUP_LATENCY seconds once the global model arrived, and costs TRAINER_WAKEUP_ENERGY joules on top of
+     * the idle wattage, consumed by a burst on every core of the host right after the latency.
+     */
+    inline static int64_t TRAINER_SLEEP_PSTATE = -1;
+    inline static double TRAINER_WAKEUP_LATENCY = 0.0;
+    inline static double TRAINER_WAKEUP_ENERGY = 0.0;
+
+    /** 
+     * Period at which aggregators of star clusters check that their trainers are still alive, 0 when nodes never fail.
+     * Trainers whose host failed are not waited for anymore, and register again once their host recovers.
+     */
+    inline static double CHURN_HEARTBEAT_PERIOD = 0.0;
+
+    /** 
+     * Mean times between the failures of each trainer host and until it recovers, both exponentially distributed and
+     * drawn from CHURN_SEED. 0 when hosts only fail according to the state profiles of the platform.
+     */
+    inline static double CHURN_MEAN_TIME_TO_FAILURE = 0.0;
+    inline static double CHURN_MEAN_TIME_TO_RECOVERY = 0.0;
+    inline static uint64_t CHURN_SEED = 0;
+
     /** Wether or not we should generate graph of the communications */ 
     inline static bool GENERATE_DOT_FILES = false;
     /* -------------------------- SIMULATION ENDING CONDITIONS -------------------------- */
@@ -36,7 +110,67 @@ public:
 
     /** Total number of local epochs before the simulation ends. 0 when the feature isn't used */
     inline static uint64_t END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS = 0;
+
+    /** Simulated accuracy of the global model before the simulation ends, see CONVERGENCE_CURVE. 0 when the feature isn't used */
+    inline static double END_CONDITION_TARGET_ACCURACY = 0.0;
+
+    /** 
+     * Energy in Joules that hosts, links and disks may consume before the simulation ends, counted from the start of
+     * the simulation. 0.0 when the feature isn't used
+     */
+    inline static double END_CONDITION_ENERGY_BUDGET = 0.0;
     /* ---------------------------------------------------------------------------------- */
+
+    /** 
+     * Curve giving the simulated accuracy of global models from their number of effective epochs, see
+     * ConvergenceModel: `exponential` or `power-law`.
+     */
+    inline static std::string CONVERGENCE_CURVE = "exponential";
+
+    /** Accuracy the curve tends to, and number of effective epochs over which it gets there */
+    inline static double CONVERGENCE_MAX_ACCURACY = 1.0;
+    inline static double CONVERGENCE_EPOCHS_SCALE = 10.0;
+
+    /** Exponent of the power-law curve */
+    inline static double CONVERGENCE_POWER = 1.0;
+
+    /** How much stale, partial and compressed local models count less towards convergence, see ConvergenceModel */
+    inline static double CONVERGENCE_STALENESS_PENALTY = 0.5;
+    inline static double CONVERGENCE_SAMPLING_PENALTY = 0.5;
+    inline static double CONVERGENCE_COMPRESSION_PENALTY = 0.1;
+
+    /** 
+     * Number of consecutive rounds that should have the same duration and energy, within STEADY_STATE_TOLERANCE, for
+     * the main aggregator to stop the simulation and extrapolate the remaining rounds. 0 when the feature isn't used.
+     */
+    inline static uint64_t STEADY_STATE_ROUNDS = 0;
+
+    /** Relative tolerance used to compare rounds, see STEADY_STATE_ROUNDS */
+    inline static double STEADY_STATE_TOLERANCE = 0.01;
+
+    /** Forbid any further change, so that actors running in parallel threads only ever read the constants */
+    static void freeze() { frozen = true; }
+
+    static bool is_frozen() { return frozen; }
+private:
+    inline static bool frozen = false;
+};
+
+/**
+ * Constants that a cluster can override with its own <constants> element, so that the clusters of a fried file can
+ * run FL jobs with different models and end conditions. Values default to the global ones.
+ */
+struct ClusterConstants
+{
+    uint64_t MODEL_SIZE_BYTES = Constants::MODEL_SIZE_BYTES;
+    double GLOBAL_MODEL_AGGREGATING_FLOPS = Constants::GLOBAL_MODEL_AGGREGATING_FLOPS;
+    double LOCAL_MODEL_TRAINING_FLOPS = Constants::LOCAL_MODEL_TRAINING_FLOPS;
+    uint64_t REFERENCE_DATASET_SIZE = Constants::REFERENCE_DATASET_SIZE;
+    uint64_t DATASET_SAMPLE_SIZE_BYTES = Constants::DATASET_SAMPLE_SIZE_BYTES;
+    double END_CONDITION_DURATION_TRAINING_PHASE = Constants::END_CONDITION_DURATION_TRAINING_PHASE;
+    uint64_t END_CONDITION_NUMBER_ROUNDS = Constants::END_CONDITION_NUMBER_ROUNDS;
+    uint64_t END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS = Constants::END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS;
+    double END_CONDITION_TARGET_ACCURACY = Constants::END_CONDITION_TARGET_ACCURACY;
 };
 
 #endif // !CONSTANTS_HPP
@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <xbt/asserts.h>
+
+#include "convergence.hpp"
+#include "constants.hpp"
+#include "utils/utils.hpp"
+
+using namespace std;
+using namespace protocol;
+
+unique_ptr<ConvergenceModel> ConvergenceModel::create()
+{
+    xbt_assert(Constants::CONVERGENCE_EPOCHS_SCALE > 0.0, "CONVERGENCE_EPOCHS_SCALE should be positive");
+
+    switch (str2int(Constants::CONVERGENCE_CURVE.c_str()))
+    {
+        case str2int("exponential"):
+            return make_unique<ExponentialConvergence>();
+        case str2int("power-law"):
+            return make_unique<PowerLawConvergence>();
+        default:
+            xbt_die("Unknown CONVERGENCE_CURVE %s, should be exponential or power-law", Constants::CONVERGENCE_CURVE.c_str());
+    }
+}
+
+void ConvergenceModel::add_local_model(const operations::SendLocalModel &local_model, uint64_t staleness,
+                                       uint64_t reference_model_size_bytes)
+{
+    // Partial aggregates already went through the penalties of their own aggregation
+    double epochs = local_model.effective_epochs != 0.0
+        ? local_model.effective_epochs
+        : (double) local_model.number_local_epochs_done / local_model.number_local_models;
+
+    double weight = 1.0 / (1.0 + Constants::CONVERGENCE_STALENESS_PENALTY * staleness);
+
+    uint64_t model_size_bytes = local_model.model_size_bytes != 0 ? local_model.model_size_bytes : reference_model_size_bytes;
+    double compression_ratio = min(1.0, (double) model_size_bytes / reference_model_size_bytes);
+    weight *= pow(compression_ratio, Constants::CONVERGENCE_COMPRESSION_PENALTY);
+
+    this->pending_epochs += epochs * weight * local_model.number_local_models;
+    this->pending_models += local_model.number_local_models;
+}
+
+void ConvergenceModel::aggregate(uint64_t number_trainers)
+{
+    this->last_effective_epochs = 0.0;
+
+    if (this->pending_models != 0 && number_trainers != 0)
+    {
+        double participation = min(1.0, (double) this->pending_models / number_trainers);
+
+        this->last_effective_epochs = this->pending_epochs / this->pending_models
+                                      * pow(participation, Constants::CONVERGENCE_SAMPLING_PENALTY);
+    }
+
+    this->effective_epochs += this->last_effective_epochs;
+
+    this->pending_epochs = 0.0;
+    this->pending_models = 0;
+}
+
+void ConvergenceModel::extrapolate(uint64_t number_aggregations)
+{
+    this->effective_epochs += number_aggregations * this->last_effective_epochs;
+}
+
+uint64_t ConvergenceModel::get_remaining_aggregations(double accuracy)
+{
+    double missing_epochs = this->get_epochs_to_reach(accuracy) - this->effective_epochs;
+
+    xbt_assert(!isinf(missing_epochs) && this->last_effective_epochs > 0.0, "Accuracy %f can never be reached", accuracy);
+
+    return max(0.0, ceil(missing_epochs / this->last_effective_epochs));
+}
+
+double ExponentialConvergence::get_accuracy_after(double effective_epochs)
+{
+    return Constants::CONVERGENCE_MAX_ACCURACY * (1.0 - exp(-effective_epochs / Constants::CONVERGENCE_EPOCHS_SCALE));
+}
+
+double ExponentialConvergence::get_epochs_to_reach(double accuracy)
+{
+    if (accuracy >= Constants::CONVERGENCE_MAX_ACCURACY)
+        return numeric_limits<double>::infinity();
+
+    return -Constants::CONVERGENCE_EPOCHS_SCALE * log(1.0 - accuracy / Constants::CONVERGENCE_MAX_ACCURACY);
+}
+
+double PowerLawConvergence::get_accuracy_after(double effective_epochs)
+{
+    return Constants::CONVERGENCE_MAX_ACCURACY
+           * (1.0 - pow(1.0 + effective_epochs / Constants::CONVERGENCE_EPOCHS_SCALE, -Constants::CONVERGENCE_POWER));
+}
+
+double PowerLawConvergence::get_epochs_to_reach(double accuracy)
+{
+    if (accuracy >= Constants::CONVERGENCE_MAX_ACCURACY)
+        return numeric_limits<double>::infinity();
+
+    return Constants::CONVERGENCE_EPOCHS_SCALE
+           * (pow(1.0 - accuracy / Constants::CONVERGENCE_MAX_ACCURACY, -1.0 / Constants::CONVERGENCE_POWER) - 1.0);
+}
@@ -0,0 +1,80 @@
+#ifndef FALAFELS_CONVERGENCE_HPP
+#define FALAFELS_CONVERGENCE_HPP
+
+#include <cstdint>
+#include <memory>
+
+#include "protocol.hpp"
+
+/**
+ * Simulated accuracy of the global model of an aggregator, as a function of the number of effective epochs it went
+ * through, see Constants::CONVERGENCE_CURVE.
+ *
+ * Each aggregation adds the mean number of local epochs of the models it aggregated, each model being weighted by:
+ * - 1 / (1 + CONVERGENCE_STALENESS_PENALTY * staleness), staleness being the number of global models produced since
+ *   the one it was trained from.
+ * - (model size / MODEL_SIZE_BYTES) ^ CONVERGENCE_COMPRESSION_PENALTY, for models sent smaller than the reference,
+ *   MODEL_SIZE_BYTES being the one of the cluster of the aggregator.
+ * The mean is then weighted by participation ^ CONVERGENCE_SAMPLING_PENALTY, participation being the fraction of
+ * the registered trainers whose model was aggregated.
+ * Partial aggregates of hierarchical aggregators carry the effective epochs of their own aggregation instead.
+ */
+class ConvergenceModel
+{
+public:
+    virtual ~ConvergenceModel() = default;
+
+    /** Create the model of Constants::CONVERGENCE_CURVE */
+    static std::unique_ptr<ConvergenceModel> create();
+
+    /** Account for a local model of the next aggregation, reference_model_size_bytes being its uncompressed size */
+    void add_local_model(const protocol::operations::SendLocalModel &local_model, uint64_t staleness,
+                         uint64_t reference_model_size_bytes);
+
+    /** Account for the aggregation of the local models added since the previous one, out of number_trainers */
+    void aggregate(uint64_t number_trainers);
+
+    /** Account for aggregations that are extrapolated instead of simulated, each one as the last simulated one */
+    void extrapolate(uint64_t number_aggregations);
+
+    /** Number of aggregations like the last one needed to reach the given accuracy, which has to be reachable */
+    uint64_t get_remaining_aggregations(double accuracy);
+
+    double get_accuracy() { return this->get_accuracy_after(this->effective_epochs); }
+
+    double get_effective_epochs() { return this->effective_epochs; }
+
+    /** Effective epochs added by the last aggregation */
+    double get_last_effective_epochs() { return this->last_effective_epochs; }
+
+    /** Accuracy reached after the given number of effective epochs */
+    virtual double get_accuracy_after(double effective_epochs) = 0;
+
+    /** Number of effective epochs needed to reach the given accuracy, infinite if it can't be reached */
+    virtual double get_epochs_to_reach(double accuracy) = 0;
+private:
+    double effective_epochs = 0.0;
+    double last_effective_epochs = 0.0;
+
+    /** Weighted local epochs and number of the local models of the next aggregation */
+    double pending_epochs = 0.0;
+    uint64_t pending_models = 0;
+};
+
+/** accuracy = CONVERGENCE_MAX_ACCURACY * (1 - exp(-effective_epochs / CONVERGENCE_EPOCHS_SCALE)) */
+class ExponentialConvergence : public ConvergenceModel
+{
+public:
+    double get_accuracy_after(double effective_epochs) override;
+    double get_epochs_to_reach(double accuracy) override;
+};
+
+/** accuracy = CONVERGENCE_MAX_ACCURACY * (1 - (1 + effective_epochs / CONVERGENCE_EPOCHS_SCALE) ^ -CONVERGENCE_POWER) */
+class PowerLawConvergence : public ConvergenceModel
+{
+public:
+    double get_accuracy_after(double effective_epochs) override;
+    double get_epochs_to_reach(double accuracy) override;
+};
+
+#endif // !FALAFELS_CONVERGENCE_HPP
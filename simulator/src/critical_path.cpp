@@ -0,0 +1,296 @@
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <limits>
+#include <set>
+#include <simgrid/s4u/Engine.hpp>
+#include <simgrid/s4u/Host.hpp>
+#include <simgrid/s4u/Link.hpp>
+#include <unordered_map>
+#include <variant>
+#include <xbt/log.h>
+
+#include "critical_path.hpp"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_critical_path, "Messages specific for this example");
+
+using namespace std;
+using namespace protocol;
+
+/** Events ending at the same time as the start of the next one are its dependencies */
+static const double EPSILON = 1e-9;
+
+string CriticalPathAnalyzer::get_host_name(const node_name &node)
+{
+    auto host = this->profiler.get_host(node);
+    return host != nullptr ? host->get_name() : node;
+}
+
+/** Last event of events, sorted by end time, that ended before the given time */
+template <typename Event>
+static const Event *find_last_before(const vector<const Event*> &events, double before)
+{
+    auto after = upper_bound(events.begin(), events.end(), before,
+                             [](double time, const Event *event) { return time < event->end; });
+
+    return after == events.begin() ? nullptr : *prev(after);
+}
+
+const PhaseProfiler::Transfer *CriticalPathAnalyzer::find_last_reception(const string &host, bool is_local_model, double before)
+{
+    auto &receptions = is_local_model ? this->local_model_receptions_by_host : this->global_model_receptions_by_host;
+
+    return find_last_before(receptions[host], before);
+}
+
+const PhaseProfiler::Transfer *CriticalPathAnalyzer::find_previous_hop(const Transfer &transfer)
+{
+    const Transfer *previous = nullptr;
+
+    for (auto hop : this->hops_by_id[transfer.id])
+    {
+        if (hop->dst == transfer.src && hop->end <= transfer.start + EPSILON
+            && (previous == nullptr || hop->end > previous->end))
+            previous = hop;
+    }
+
+    return previous;
+}
+
+const PhaseProfiler::Computation *CriticalPathAnalyzer::find_last_computation(const string &host, bool aggregation_only, double before)
+{
+    auto &computations = aggregation_only ? this->aggregations_by_host : this->computations_by_host;
+
+    return find_last_before(computations[host], before);
+}
+
+/** Sort each list of events by end time, keeping the recording order of events ending at the same time */
+template <typename Event>
+static void sort_by_end(unordered_map<string, vector<const Event*>> &events_by_host)
+{
+    for (auto &[_, events] : events_by_host)
+        stable_sort(events.begin(), events.end(), [](const Event *a, const Event *b) { return a->end < b->end; });
+}
+
+void CriticalPathAnalyzer::build_indexes()
+{
+    for (auto &transfer : this->profiler.get_transfers())
+    {
+        auto dst_host = this->get_host_name(transfer.dst);
+
+        if (transfer.is_local_model)
+            this->local_model_receptions_by_host[dst_host].push_back(&transfer);
+        if (transfer.is_global_model)
+            this->global_model_receptions_by_host[dst_host].push_back(&transfer);
+
+        this->hops_by_id[transfer.id].push_back(&transfer);
+    }
+
+    for (auto &computation : this->profiler.get_computations())
+    {
+        this->computations_by_host[computation.host->get_name()].push_back(&computation);
+
+        if (computation.phase == PhaseProfiler::AGGREGATION)
+            this->aggregations_by_host[computation.host->get_name()].push_back(&computation);
+    }
+
+    sort_by_end(this->local_model_receptions_by_host);
+    sort_by_end(this->global_model_receptions_by_host);
+    sort_by_end(this->computations_by_host);
+    sort_by_end(this->aggregations_by_host);
+}
+
+void CriticalPathAnalyzer::set_route(Step &step, const string &src_host, const string &dst_host)
+{
+    auto it = this->routes.find({ src_host, dst_host });
+
+    if (it == this->routes.end())
+    {
+        auto e = simgrid::s4u::Engine::get_instance();
+
+        vector<simgrid::s4u::Link*> links;
+        double latency = 0.0;
+        e->host_by_name(src_host)->route_to(e->host_by_name(dst_host), links, &latency);
+
+        string bottleneck = "";
+        double lowest_bandwidth = numeric_limits<double>::infinity();
+        vector<string> route;
+
+        for (auto link : links)
+        {
+            route.push_back(link->get_name());
+
+            if (link->get_bandwidth() < lowest_bandwidth)
+            {
+                lowest_bandwidth = link->get_bandwidth();
+                bottleneck = link->get_name();
+            }
+        }
+
+        it = this->routes.insert({ { src_host, dst_host }, { bottleneck, route } }).first;
+    }
+
+    step.bottleneck = it->second.first;
+    step.route = it->second.second;
+}
+
+vector<CriticalPathAnalyzer::Step> CriticalPathAnalyzer::follow_round(const Computation &aggregation)
+{
+    const string root_host = aggregation.host->get_name();
+
+    vector<Step> path;
+    path.push_back(Step { .kind="aggregation", .host=root_host, .start=aggregation.start, .end=aggregation.end });
+
+    variant<const Computation*, const Transfer*> current = &aggregation;
+
+    // Each step ends before the previous one starts, the bound only protects against zero-duration cycles
+    const size_t max_steps = 2 * (this->profiler.get_computations().size() + this->profiler.get_transfers().size());
+
+    while (path.size() < max_steps)
+    {
+        double current_start;
+        string current_host;
+        variant<const Computation*, const Transfer*> predecessor;
+
+        if (auto computation = get_if<const Computation*>(&current))
+        {
+            current_start = (*computation)->start;
+            current_host = (*computation)->host->get_name();
+
+            // Aggregations wait for local models, trainings for a global model
+            auto reception = this->find_last_reception(
+                current_host, (*computation)->phase == PhaseProfiler::AGGREGATION, current_start + EPSILON
+            );
+
+            if (reception == nullptr)
+                break;
+
+            predecessor = reception;
+        }
+        else
+        {
+            auto transfer = get<const Transfer*>(current);
+            current_start = transfer->start;
+            current_host = this->get_host_name(transfer->src);
+
+            const Transfer *previous_hop = nullptr;
+            if (transfer->src != transfer->original_src)
+                previous_hop = this->find_previous_hop(*transfer);
+
+            if (previous_hop != nullptr)
+            {
+                predecessor = previous_hop;
+            }
+            else
+            {
+                // Local models are sent after a training (or an aggregation in trees), global models after an aggregation
+                auto computation = this->find_last_computation(current_host, !transfer->is_local_model, current_start + EPSILON);
+
+                if (computation == nullptr)
+                    break;
+
+                predecessor = computation;
+            }
+        }
+
+        double predecessor_end = visit([](auto event) { return event->end; }, predecessor);
+
+        if (current_start - predecessor_end > EPSILON)
+            path.push_back(Step { .kind="wait", .host=current_host, .start=predecessor_end, .end=current_start });
+
+        if (auto computation = get_if<const Computation*>(&predecessor))
+        {
+            // The previous aggregation of the root is where the round started
+            if ((*computation)->phase == PhaseProfiler::AGGREGATION && (*computation)->host->get_name() == root_host)
+                break;
+
+            path.push_back(Step {
+                .kind=(*computation)->phase == PhaseProfiler::TRAINING ? "training" : "aggregation",
+                .host=(*computation)->host->get_name(), .start=(*computation)->start, .end=(*computation)->end
+            });
+        }
+        else
+        {
+            auto transfer = get<const Transfer*>(predecessor);
+            auto step = Step {
+                .kind=transfer->is_local_model ? "upload" : "broadcast",
+                .host=this->get_host_name(transfer->src), .start=transfer->start, .end=transfer->end
+            };
+            this->set_route(step, step.host, this->get_host_name(transfer->dst));
+            path.push_back(step);
+        }
+
+        current = predecessor;
+    }
+
+    return path;
+}
+
+/** Log the contributors with the largest times */
+static void log_top_contributors(const char *name, const unordered_map<string, double> &times)
+{
+    vector<pair<string, double>> sorted(times.begin(), times.end());
+    sort(sorted.begin(), sorted.end(), [](auto &a, auto &b) { return a.second > b.second; });
+
+    for (size_t i = 0; i < min(sorted.size(), (size_t) 5); i++)
+        XBT_INFO("Critical %s: %s (%f s)", name, sorted[i].first.c_str(), sorted[i].second);
+}
+
+void CriticalPathAnalyzer::analyze(const string &output_dir)
+{
+    this->build_indexes();
+
+    // Root aggregators are the ones that never send a local model
+    set<node_name> senders_local_models;
+    for (auto &transfer : this->profiler.get_transfers())
+    {
+        if (transfer.is_local_model)
+            senders_local_models.insert(transfer.original_src);
+    }
+
+    ofstream file(std::format("{}/critical_path.csv", output_dir));
+    file << "aggregator,round,step,kind,host,bottleneck_link,route,start,end,duration\n";
+
+    unordered_map<string, double> host_times;
+    unordered_map<string, double> link_times;
+    unordered_map<string, double> wait_times;
+    unordered_map<node_name, uint32_t> rounds;
+
+    for (auto &computation : this->profiler.get_computations())
+    {
+        if (computation.phase != PhaseProfiler::AGGREGATION || senders_local_models.contains(computation.node))
+            continue;
+
+        uint32_t round = ++rounds[computation.node];
+        auto path = this->follow_round(computation);
+
+        // Steps were found backwards
+        reverse(path.begin(), path.end());
+
+        for (size_t i = 0; i < path.size(); i++)
+        {
+            auto &step = path[i];
+            double duration = step.end - step.start;
+
+            string route = "";
+            for (auto &link : step.route)
+                route += route.empty() ? link : ";" + link;
+
+            file << std::format("{},{},{},{},{},{},{},{},{},{}\n", computation.node, round, i, step.kind, step.host,
+                                step.bottleneck, route, step.start, step.end, duration);
+
+            // Transfers are slowed down by their bottleneck, or by their hosts when they stay on the same one.
+            // Waits aren't caused by the speed of the host, upgrading it wouldn't shorten them.
+            if (step.kind == "wait")
+                wait_times[step.host] += duration;
+            else if (!step.bottleneck.empty())
+                link_times[step.bottleneck] += duration;
+            else
+                host_times[step.host] += duration;
+        }
+    }
+
+    log_top_contributors("host", host_times);
+    log_top_contributors("link", link_times);
+    log_top_contributors("waiting host", wait_times);
+}
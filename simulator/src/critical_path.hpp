@@ -0,0 +1,78 @@
+#ifndef FALAFELS_CRITICAL_PATH_HPP
+#define FALAFELS_CRITICAL_PATH_HPP
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "profiler.hpp"
+
+/**
+ * Rebuild the dependency graph of each round from the computations and transfers recorded by PhaseProfiler, and
+ * follow it backwards from every aggregation of the root aggregators: an aggregation waits for the last local model
+ * it received, a transfer for its previous hop or for the computation of its sender, and a training for the last
+ * global model its trainer received.
+ * The critical path of each round is written in DIR/critical_path.csv, and the hosts and links that contributed the
+ * most are logged, as they are the ones worth upgrading to shorten rounds. The hosts that waited the most, e.g. for a
+ * timeout, are logged separately since upgrading them wouldn't help.
+ */
+class CriticalPathAnalyzer
+{
+public:
+    CriticalPathAnalyzer(PhaseProfiler &profiler) : profiler(profiler) {}
+
+    void analyze(const std::string &output_dir);
+private:
+    PhaseProfiler &profiler;
+
+    /** Step of a critical path, either a computation, a transfer or the time a node waited in between */
+    struct Step
+    {
+        std::string kind;
+        std::string host;
+        /** Link with the lowest bandwidth on the route of a transfer, and the whole route */
+        std::string bottleneck;
+        std::vector<std::string> route;
+        double start;
+        double end;
+    };
+
+    using Computation = PhaseProfiler::Computation;
+    using Transfer = PhaseProfiler::Transfer;
+
+    /** Last transfer of the given kind received by a host before the given time */
+    const Transfer *find_last_reception(const std::string &host, bool is_local_model, double before);
+
+    /** Hop that brought a redirected packet to the node that sent the given transfer */
+    const Transfer *find_previous_hop(const Transfer &transfer);
+
+    /** Last computation of a host that ended before the given time, restricted to aggregations if specified */
+    const Computation *find_last_computation(const std::string &host, bool aggregation_only, double before);
+
+    std::string get_host_name(const protocol::node_name &node);
+
+    /** Fill the route and bottleneck of a transfer step between two hosts */
+    void set_route(Step &step, const std::string &src_host, const std::string &dst_host);
+
+    /** Critical path of the round ending with the given aggregation, from its end to its start */
+    std::vector<Step> follow_round(const Computation &aggregation);
+
+    /** 
+     * Indexes of the recorded events, to avoid scanning all of them at each step. Receptions and computations are
+     * sorted by end time, so that the last one before a given time is found with a binary search.
+     */
+    std::unordered_map<std::string, std::vector<const Transfer*>> local_model_receptions_by_host;
+    std::unordered_map<std::string, std::vector<const Transfer*>> global_model_receptions_by_host;
+    std::unordered_map<protocol::packet_id, std::vector<const Transfer*>> hops_by_id;
+    std::unordered_map<std::string, std::vector<const Computation*>> computations_by_host;
+    std::unordered_map<std::string, std::vector<const Computation*>> aggregations_by_host;
+
+    void build_indexes();
+
+    /** Routes already computed, with their bottleneck */
+    std::map<std::pair<std::string, std::string>, std::pair<std::string, std::vector<std::string>>> routes;
+};
+
+#endif // !FALAFELS_CRITICAL_PATH_HPP
@@ -2,6 +2,8 @@
 #include "protocol.hpp"
 #include <format>
 #include <fstream>
+#include <map>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -11,51 +13,52 @@ using namespace std;
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_dot, "Messages specific for this example");
 
-DOTGenerator::DOTGenerator() 
-{
-    this->dot_states = new unordered_map<double, vector<string>*>();
-    this->cluster_map = new unordered_map<string, vector<string>*>();
-}
+DOTGenerator::DOTGenerator() {}
 
 DOTGenerator::~DOTGenerator()
 {
-    for (auto [_, vec]: *this->dot_states) { delete vec; }
-    for (auto [_, vec]: *this->cluster_map) { delete vec; }
-
-    delete this->dot_states;
-    delete this->cluster_map;
+    for (auto shard: this->shards) { delete shard; }
 }
 
-void DOTGenerator::add_to_cluster(string cluster_name, string line)
+DOTGenerator::Shard *DOTGenerator::get_local_shard()
 {
-    // Replace hierarchical_ namespace, because on the graph they represent the same node
-    replace_all(line, "hierarchical_", "");
+    thread_local Shard *shard = nullptr;
 
-    if (this->cluster_map->contains(cluster_name))
+    if (shard == nullptr)
     {
-        this->cluster_map->at(cluster_name)->push_back(line);
-    }
-    else 
-    {
-        this->cluster_map->insert({ cluster_name, new vector<string>({line}) });
+        shard = new Shard();
+
+        std::lock_guard lock(this->mutex);
+        this->shards.push_back(shard);
     }
+
+    return shard;
 }
 
-void DOTGenerator::add_to_state(double current_time, string line)
+void DOTGenerator::add_alias(string alias, string name)
 {
-    // Replace hierarchical_ namespace, because on the graph they represent the same node
-    replace_all(line, "hierarchical_", "");
+    std::lock_guard lock(this->mutex);
+    this->aliases.insert({ alias, name });
+}
 
-    if (this->dot_states->contains(current_time))
-    {
-        this->dot_states->at(current_time)->push_back(line);
-    }
-    else 
+void DOTGenerator::replace_aliases(string &line)
+{
+    for (auto &[alias, name]: this->aliases)
     {
-        this->dot_states->insert({ current_time, new vector<string>({line}) });
+        replace_all(line, alias, name);
     }
 }
 
+void DOTGenerator::add_to_cluster(string cluster_name, string line)
+{
+    this->get_local_shard()->cluster_map[cluster_name].push_back(line);
+}
+
+void DOTGenerator::add_to_state(double current_time, string line)
+{
+    this->get_local_shard()->dot_states[current_time].push_back(line);
+}
+
 string fill_zeros(string str)
 {
     uint8_t nb_to_fill = 18 - str.size();
@@ -68,14 +71,14 @@ string fill_zeros(string str)
     return str;
 }
 
-void DOTGenerator::display_clusters(ofstream &graph_file)
+void DOTGenerator::display_clusters(ofstream &graph_file, const map<string, vector<string>> &cluster_map)
 {
-    for (auto [cluster_name, lines]: *cluster_map)
+    for (auto &[cluster_name, lines]: cluster_map)
     {
         graph_file << "\tsubgraph {\n";
         graph_file << "\t\tedge [style=\"invis\"]\n";
 
-        for (auto line: *lines)
+        for (auto line: lines)
         {
             graph_file << std::format("\t\t{};\n", line);
         }
@@ -83,9 +86,37 @@ void DOTGenerator::display_clusters(ofstream &graph_file)
         graph_file << "\t}\n";
     }
 }
+
 void DOTGenerator::generate_state_files()
 {
-    for (auto [time, links] : *this->dot_states)
+    std::lock_guard lock(this->mutex);
+
+    // Merge the shards. Aliases are replaced here, because on the graph they represent the same node
+    map<string, vector<string>> cluster_map;
+    map<double, vector<string>> dot_states;
+
+    for (auto shard: this->shards)
+    {
+        for (auto &[cluster_name, lines]: shard->cluster_map)
+        {
+            for (auto line: lines)
+            {
+                this->replace_aliases(line);
+                cluster_map[cluster_name].push_back(line);
+            }
+        }
+
+        for (auto &[time, lines]: shard->dot_states)
+        {
+            for (auto line: lines)
+            {
+                this->replace_aliases(line);
+                dot_states[time].push_back(line);
+            }
+        }
+    }
+
+    for (auto &[time, links] : dot_states)
     {
         std::ofstream graph_file;
 
@@ -96,10 +127,10 @@ void DOTGenerator::generate_state_files()
         graph_file << "\tsize=5\n";
         graph_file << "\tratio=fill\n";
 
-        this->display_clusters(graph_file);
+        this->display_clusters(graph_file, cluster_map);
 
         // Add packet events 
-        for (auto event : *links)
+        for (auto event : links)
         {
             // XBT_INFO("[%f]: %s", time, event.c_str());
             graph_file << std::format("\t{}\n", event);
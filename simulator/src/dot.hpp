@@ -1,6 +1,8 @@
 #ifndef DOT_HPP
 #define DOT_HPP
 
+#include <map>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -10,6 +12,8 @@
 
 /**
  * Singleton used to generate DOT files that can render graphs of the simulation.
+ * Lines are stored in per-thread shards merged at generation time, so that it can be used by actors running in 
+ * parallel contexts.
  */
 class DOTGenerator
 {
@@ -25,6 +29,8 @@ public:
     DOTGenerator(DOTGenerator const&) = delete;
     void operator=(DOTGenerator const&) = delete;
 
+    /** Render every occurrence of alias as name, used when several mailboxes represent the same node */
+    void add_alias(std::string alias, std::string name);
     void add_to_cluster(std::string cluster_name, std::string line);
     void add_to_state(double current_time, std::string line);
     void generate_state_files();
@@ -32,10 +38,24 @@ private:
     DOTGenerator(); 
     ~DOTGenerator();
 
-    std::unordered_map<std::string, std::vector<std::string>*> *cluster_map;
-    std::unordered_map<double, std::vector<std::string>*> *dot_states;
+    /** Lines recorded by a single thread */
+    struct Shard
+    {
+        std::unordered_map<std::string, std::vector<std::string>> cluster_map;
+        std::unordered_map<double, std::vector<std::string>> dot_states;
+    };
+
+    /** Get the shard of the calling thread, creating it on first use */
+    Shard *get_local_shard();
+
+    /** Protects shards and aliases */
+    std::mutex mutex;
+    std::vector<Shard*> shards;
+    std::unordered_map<std::string, std::string> aliases;
+
+    void replace_aliases(std::string &line);
 
-    void display_clusters(std::ofstream &graph_file);
+    void display_clusters(std::ofstream &graph_file, const std::map<std::string, std::vector<std::string>> &cluster_map);
 };
 
 #endif //!DOT_HPP
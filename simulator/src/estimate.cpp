@@ -0,0 +1,613 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <pugixml.hpp>
+#include <simgrid/s4u/Disk.hpp>
+#include <simgrid/s4u/Engine.hpp>
+#include <simgrid/s4u/Host.hpp>
+#include <simgrid/s4u/Link.hpp>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <xbt/asserts.h>
+#include <xbt/log.h>
+
+#include "estimate.hpp"
+#include "constants.hpp"
+#include "convergence.hpp"
+#include "protocol.hpp"
+#include "utils/utils.hpp"
+#include "node/roles/aggregator/aggregator.hpp"
+#include "node/roles/trainer/trainer.hpp"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_estimate, "Messages specific for this example");
+
+using namespace std;
+using namespace protocol;
+using simgrid::s4u::Disk;
+using simgrid::s4u::Host;
+using simgrid::s4u::Link;
+
+/** A Node of the deployment, as far as the estimation is concerned */
+struct EstimatedNode
+{
+    node_name name;
+    bool is_trainer = true;
+
+    /** Number of local epochs an aggregator asks its children to perform */
+    uint8_t number_local_epochs = 3;
+
+    /** Trainers of the cluster of an aggregator, and aggregators whose parent it is */
+    vector<node_name> children;
+
+    /** Arguments of a trainer, see Trainer */
+    optional<uint64_t> dataset_size;
+    optional<uint64_t> shard_size_bytes;
+    optional<string> disk_name;
+};
+
+/** Transfer of a packet between two hosts */
+struct Flow
+{
+    /** Links of the route, FATPIPE ones aren't shared between flows */
+    vector<Link*> links;
+
+    double remaining_bytes;
+
+    /** Time from which the flow consumes bandwidth, i.e. after the latency of its route */
+    double start;
+
+    /** Bound of the rate of the flow, either set by the TCP window or by FATPIPE links */
+    double max_rate;
+
+    /** Called with the completion time of the flow */
+    function<void(double)> on_complete;
+
+    double rate = 0.0;
+    bool done = false;
+};
+
+/**
+ * Fluid simulation of concurrent flows: rates follow max-min fairness over the shared links, and are recomputed each
+ * time a flow starts or completes.
+ */
+class FlowSimulation
+{
+public:
+    FlowSimulation(unordered_map<Link*, double> *transferred_bytes) : transferred_bytes(transferred_bytes) {}
+
+    /** Add a flow sending bytes from src to dst, which starts at the given time */
+    void add_flow(Host *src, Host *dst, double bytes, double start, function<void(double)> on_complete=nullptr)
+    {
+        auto flow = make_unique<Flow>();
+        double latency = 0.0;
+
+        src->route_to(dst, flow->links, &latency);
+
+        flow->remaining_bytes = bytes;
+        flow->start = start + latency * LATENCY_FACTOR;
+        flow->on_complete = on_complete;
+
+        // The TCP window bounds the rate with the raw latency of the route
+        double tcp_gamma = simgrid::s4u::Engine::get_config<double>("network/TCP-gamma");
+        flow->max_rate = latency > 0.0 && tcp_gamma > 0.0 ? tcp_gamma / (2.0 * latency) : numeric_limits<double>::infinity();
+
+        for (auto link: flow->links)
+        {
+            (*this->transferred_bytes)[link] += bytes;
+
+            if (link->get_sharing_policy() == Link::SharingPolicy::FATPIPE)
+                flow->max_rate = min(flow->max_rate, link->get_bandwidth() * BANDWIDTH_FACTOR);
+        }
+
+        this->flows.push_back(std::move(flow));
+    }
+
+    /** Run until every flow completes, flows added by completion callbacks included. Returns the current time */
+    double run()
+    {
+        while (true)
+        {
+            vector<Flow*> active;
+            double next_start = numeric_limits<double>::infinity();
+
+            for (auto &flow: this->flows)
+            {
+                if (flow->done)
+                    continue;
+
+                if (flow->start <= this->now)
+                    active.push_back(flow.get());
+                else
+                    next_start = min(next_start, flow->start);
+            }
+
+            if (active.empty() && isinf(next_start))
+                break;
+
+            this->share_bandwidth(active);
+
+            vector<double> completions;
+            for (auto flow: active)
+                completions.push_back(this->now + flow->remaining_bytes / flow->rate);
+
+            double next_event = next_start;
+            for (auto completion: completions)
+                next_event = min(next_event, completion);
+
+            for (size_t i = 0; i < active.size(); i++)
+            {
+                if (completions[i] <= next_event)
+                {
+                    active[i]->remaining_bytes = 0.0;
+                    active[i]->done = true;
+                }
+                else
+                {
+                    active[i]->remaining_bytes -= active[i]->rate * (next_event - this->now);
+                }
+            }
+
+            this->now = next_event;
+
+            // Call completion callbacks afterwards, as they may add flows
+            for (auto flow: active)
+            {
+                if (flow->done && flow->on_complete)
+                    flow->on_complete(this->now);
+            }
+        }
+
+        return this->now;
+    }
+private:
+    vector<unique_ptr<Flow>> flows;
+
+    unordered_map<Link*, double> *transferred_bytes;
+
+    double now = 0.0;
+
+    /** Max-min fair sharing of the shared links between the active flows */
+    void share_bandwidth(const vector<Flow*> &active)
+    {
+        unordered_map<Link*, double> remaining_capacity;
+        unordered_map<Link*, uint64_t> nb_unfixed_flows;
+
+        for (auto flow: active)
+        {
+            for (auto link: flow->links)
+            {
+                if (link->get_sharing_policy() == Link::SharingPolicy::FATPIPE)
+                    continue;
+
+                remaining_capacity[link] = link->get_bandwidth() * BANDWIDTH_FACTOR;
+                nb_unfixed_flows[link] += 1;
+            }
+        }
+
+        auto fix_rate = [&](Flow *flow, double rate)
+        {
+            flow->rate = rate;
+
+            for (auto link: flow->links)
+            {
+                if (!nb_unfixed_flows.contains(link))
+                    continue;
+
+                remaining_capacity[link] -= rate;
+                nb_unfixed_flows[link] -= 1;
+            }
+        };
+
+        vector<Flow*> unfixed(active);
+
+        while (!unfixed.empty())
+        {
+            // Find the link offering the smallest fair share
+            Link *bottleneck = nullptr;
+            double share = numeric_limits<double>::infinity();
+
+            for (auto &[link, nb_flows]: nb_unfixed_flows)
+            {
+                if (nb_flows > 0 && remaining_capacity[link] / nb_flows < share)
+                {
+                    share = remaining_capacity[link] / nb_flows;
+                    bottleneck = link;
+                }
+            }
+
+            // Flows bounded below that share are fixed first, leaving more bandwidth to the others
+            auto most_bounded = min_element(unfixed.begin(), unfixed.end(), 
+                [](Flow *a, Flow *b) { return a->max_rate < b->max_rate; }
+            );
+
+            if ((*most_bounded)->max_rate <= share)
+            {
+                fix_rate(*most_bounded, (*most_bounded)->max_rate);
+                unfixed.erase(most_bounded);
+                continue;
+            }
+
+            vector<Flow*> still_unfixed;
+            for (auto flow: unfixed)
+            {
+                if (find(flow->links.begin(), flow->links.end(), bottleneck) != flow->links.end())
+                    fix_rate(flow, share);
+                else
+                    still_unfixed.push_back(flow);
+            }
+
+            unfixed = still_unfixed;
+        }
+    }
+};
+
+/** Simulated size of a packet sent from src to dst */
+static double get_packet_size(node_name src, node_name dst, operations::Operation op)
+{
+    Packet p(dst, dst, op);
+    p.src = src;
+    p.original_src = src;
+
+    return p.get_packet_size();
+}
+
+class Estimator
+{
+public:
+    Estimator(const char *fried_path);
+
+    SimulationResult estimate();
+private:
+    unordered_map<node_name, EstimatedNode> nodes;
+
+    /** Name of the main aggregator */
+    node_name root;
+
+    /** Seconds spent computing by each host during a round of the main aggregator */
+    unordered_map<Host*, double> busy_time;
+
+    /** Seconds spent reading by each disk during a round of the main aggregator */
+    unordered_map<Disk*, double> disk_busy_time;
+
+    /** Bytes sent through each link during a round of the main aggregator */
+    unordered_map<Link*, double> transferred_bytes;
+
+    /** Duration between the reception of the global model by an aggregator and its aggregated model */
+    double estimate_round(const EstimatedNode &aggregator);
+
+    /** Duration between the reception of the global model by a node and the sending of its model */
+    double estimate_model_production(const EstimatedNode &node, uint8_t number_local_epochs);
+
+    /** Number of local epochs done by the trainers of the subtree of an aggregator during one of its rounds */
+    uint64_t get_number_local_epochs_per_round(const EstimatedNode &aggregator);
+
+    /** Effective epochs a round of an aggregator adds to its global model, see ConvergenceModel */
+    double get_effective_epochs_per_round(const EstimatedNode &aggregator);
+};
+
+Estimator::Estimator(const char *fried_path)
+{
+    pugi::xml_document doc;
+    xbt_assert(doc.load_file(fried_path), "Error while loading fried falafels deployment file");
+
+    unordered_map<node_name, node_name> parents;
+
+    for (auto cluster: doc.child("fried").children("cluster"))
+    {
+        string topology = cluster.attribute("topology").as_string();
+
+        xbt_assert(!cluster.child("constants"), "Estimations don't support clusters with their own constants");
+
+        optional<node_name> aggregator_name;
+        vector<node_name> trainers;
+
+        for (auto node_elem: cluster.children("node"))
+        {
+            EstimatedNode node { .name = node_elem.attribute("name").as_string() };
+            auto role_elem = node_elem.first_child();
+
+            if (strcmp(role_elem.name(), "aggregator") == 0)
+            {
+                string type = role_elem.attribute("type").as_string();
+                xbt_assert(type == "simple" || type == "hierarchical", "Estimations don't support %s aggregators", type.c_str());
+
+                node.is_trainer = false;
+                aggregator_name = node.name;
+
+                for (auto arg: role_elem.children())
+                {
+                    switch (str2int(arg.attribute("name").as_string()))
+                    {
+                        case str2int("number_local_epochs"):
+                            node.number_local_epochs = arg.attribute("value").as_int();
+                            break;
+                        case str2int("central_aggregator_name"):
+                        case str2int("parent_aggregator_name"):
+                            parents[node.name] = arg.attribute("value").as_string();
+                            break;
+                    }
+                }
+            }
+            else
+            {
+                for (auto arg: role_elem.children())
+                {
+                    switch (str2int(arg.attribute("name").as_string()))
+                    {
+                        case str2int("dataset_size"):
+                        case str2int("samples"):
+                            node.dataset_size = arg.attribute("value").as_ullong();
+                            break;
+                        case str2int("shard_size_bytes"):
+                            node.shard_size_bytes = arg.attribute("value").as_ullong();
+                            break;
+                        case str2int("disk"):
+                            node.disk_name = arg.attribute("value").as_string();
+                            break;
+                    }
+                }
+
+                trainers.push_back(node.name);
+            }
+
+            this->nodes[node.name] = node;
+        }
+
+        if (trainers.empty())
+            continue;
+
+        xbt_assert(topology == "star", "Estimations only support star clusters of trainers, not %s", topology.c_str());
+        xbt_assert(aggregator_name.has_value(), "Star cluster without aggregator");
+
+        for (auto trainer: trainers)
+            this->nodes.at(*aggregator_name).children.push_back(trainer);
+    }
+
+    for (auto &[child, parent]: parents)
+        this->nodes.at(parent).children.push_back(child);
+
+    // The main aggregator is the only aggregator without parent
+    for (auto &[name, node]: this->nodes)
+    {
+        if (node.is_trainer || parents.contains(name))
+            continue;
+
+        xbt_assert(this->root.empty(), "Estimations need a single root aggregator, found %s and %s", this->root.c_str(), name.c_str());
+        this->root = name;
+    }
+
+    xbt_assert(!this->root.empty(), "No root aggregator found");
+}
+
+double Estimator::estimate_model_production(const EstimatedNode &node, uint8_t number_local_epochs)
+{
+    if (!node.is_trainer)
+        return this->estimate_round(node);
+
+    auto host = simgrid::s4u::Engine::get_instance()->host_by_name(node.name);
+
+    xbt_assert(Constants::REFERENCE_DATASET_SIZE != 0, "REFERENCE_DATASET_SIZE cannot be 0");
+
+    // Same cost as Trainer::run_epochs(), proportional to the number of samples of the trainer
+    uint64_t dataset_size = node.dataset_size.value_or(Constants::REFERENCE_DATASET_SIZE);
+    double dataset_ratio = (double) dataset_size / Constants::REFERENCE_DATASET_SIZE;
+
+    double training_time = Trainer::get_training_flops_per_core(
+        Constants::LOCAL_MODEL_TRAINING_FLOPS * dataset_ratio, host->get_core_count(), number_local_epochs
+    ) / host->get_speed();
+
+    this->busy_time[host] += training_time;
+
+    // Same reads as Trainer::train() once the shard is in the page cache, if it is kept there
+    uint64_t shard_size_bytes = node.shard_size_bytes.value_or(dataset_size * Constants::DATASET_SAMPLE_SIZE_BYTES);
+
+    if (shard_size_bytes == 0 || Constants::DATASET_PAGE_CACHE)
+        return training_time;
+
+    auto disks = host->get_disks();
+    auto disk = find_if(disks.begin(), disks.end(), [&node](Disk *d) {
+        return !node.disk_name || d->get_name() == *node.disk_name;
+    });
+
+    xbt_assert(disk != disks.end(), "Trainer %s reads its dataset, but host %s has no disk%s",
+               node.name.c_str(), host->get_cname(), node.disk_name ? (" named " + *node.disk_name).c_str() : "");
+
+    double reading_time = number_local_epochs * shard_size_bytes / (*disk)->get_read_bandwidth();
+    this->disk_busy_time[*disk] += reading_time;
+
+    return reading_time + training_time;
+}
+
+double Estimator::estimate_round(const EstimatedNode &aggregator)
+{
+    auto e = simgrid::s4u::Engine::get_instance();
+    auto aggregator_host = e->host_by_name(aggregator.name);
+
+    FlowSimulation flows(&this->transferred_bytes);
+
+    // The global model is sent to every child, which sends back its model once produced
+    for (auto &child_name: aggregator.children)
+    {
+        auto &child = this->nodes.at(child_name);
+        auto child_host = e->host_by_name(child_name);
+
+        double global_model_size = get_packet_size(
+            aggregator.name, child_name, operations::SendGlobalModel(aggregator.number_local_epochs)
+        );
+        double local_model_size = get_packet_size(
+            child_name, aggregator.name, operations::SendLocalModel(aggregator.number_local_epochs)
+        );
+
+        flows.add_flow(aggregator_host, child_host, global_model_size, 0.0,
+            [this, &flows, &aggregator, &child, aggregator_host, child_host, local_model_size](double received)
+            {
+                double sent = received + this->estimate_model_production(child, aggregator.number_local_epochs);
+                flows.add_flow(child_host, aggregator_host, local_model_size, sent);
+            }
+        );
+    }
+
+    double last_model_received = flows.run();
+
+    double aggregating_time = 
+        Aggregator::get_aggregating_flops_per_core(
+            Constants::GLOBAL_MODEL_AGGREGATING_FLOPS, aggregator_host->get_core_count(), aggregator.children.size()
+        ) / aggregator_host->get_speed();
+
+    this->busy_time[aggregator_host] += aggregating_time;
+
+    return last_model_received + aggregating_time;
+}
+
+uint64_t Estimator::get_number_local_epochs_per_round(const EstimatedNode &aggregator)
+{
+    uint64_t number_local_epochs = 0;
+
+    for (auto &child_name: aggregator.children)
+    {
+        auto &child = this->nodes.at(child_name);
+
+        if (child.is_trainer)
+            number_local_epochs += aggregator.number_local_epochs;
+        else
+            number_local_epochs += this->get_number_local_epochs_per_round(child);
+    }
+
+    return number_local_epochs;
+}
+
+double Estimator::get_effective_epochs_per_round(const EstimatedNode &aggregator)
+{
+    // Synchronous rounds aggregate the models of every child, trained from the latest global model
+    double effective_epochs = 0.0;
+
+    for (auto &child_name: aggregator.children)
+    {
+        auto &child = this->nodes.at(child_name);
+
+        if (child.is_trainer)
+            effective_epochs += aggregator.number_local_epochs;
+        else
+            effective_epochs += this->get_effective_epochs_per_round(child);
+    }
+
+    return effective_epochs / aggregator.children.size();
+}
+
+SimulationResult Estimator::estimate()
+{
+    auto e = simgrid::s4u::Engine::get_instance();
+    auto &root = this->nodes.at(this->root);
+
+    double round_time = this->estimate_round(root);
+
+    // Energy of a single round, the one of the whole simulation being proportional to its number of rounds
+    SimulationResult result;
+    result.simulation_time = round_time;
+
+    for (auto host: e->get_all_hosts())
+    {
+        // Idle, one core and all cores wattages. Our activities always use every core.
+        auto wattages = parse_wattages(host->get_property("wattage_per_state"), host->get_pstate());
+        double idle = wattages.empty() ? 0.0 : wattages.front();
+        double all_cores = wattages.empty() ? 0.0 : wattages.back();
+
+        double busy = min(this->busy_time[host], result.simulation_time);
+        double energy = idle * (result.simulation_time - busy) + all_cores * busy;
+
+        result.total_host_consumption += energy;
+
+        if (this->nodes.contains(host->get_name()))
+            result.used_host_consumption += energy;
+        else
+            result.idle_host_consumption += energy;
+    }
+
+    for (auto link: e->get_all_links())
+    {
+        // Idle and busy wattages, the dynamic part being proportional to the link's usage
+        auto wattages = parse_wattages(link->get_property("wattage_range"), 0);
+        if (wattages.size() < 2)
+            continue;
+
+        double busy = min(this->transferred_bytes[link] / link->get_bandwidth(), result.simulation_time);
+
+        result.total_link_consumption += wattages[0] * result.simulation_time + (wattages[1] - wattages[0]) * busy;
+    }
+
+    for (auto host: e->get_all_hosts())
+    {
+        for (auto disk: host->get_disks())
+        {
+            // Properties of SimGrid's disk energy plugin, disks draw their idle wattage when they aren't read
+            auto idle = disk->get_property("wattage_idle");
+            auto read = disk->get_property("wattage_read");
+            if (idle == nullptr || read == nullptr)
+                continue;
+
+            double busy = min(this->disk_busy_time[disk], result.simulation_time);
+
+            result.total_disk_consumption += stod(idle) * result.simulation_time + (stod(read) - stod(idle)) * busy;
+        }
+    }
+
+    // Same end conditions as Aggregator::check_end_condition(). The duration and the energy budget stop the
+    // simulation during its last round, which is only counted partially.
+    double number_rounds;
+
+    if (Constants::END_CONDITION_DURATION_TRAINING_PHASE != 0.0)
+    {
+        number_rounds = Constants::END_CONDITION_DURATION_TRAINING_PHASE / round_time;
+    }
+    else if (Constants::END_CONDITION_NUMBER_ROUNDS != 0)
+    {
+        number_rounds = Constants::END_CONDITION_NUMBER_ROUNDS;
+    }
+    else if (Constants::END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS != 0)
+    {
+        uint64_t number_local_epochs = this->get_number_local_epochs_per_round(root);
+        number_rounds = (Constants::END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS + number_local_epochs - 1) / number_local_epochs;
+    }
+    else if (Constants::END_CONDITION_TARGET_ACCURACY != 0.0)
+    {
+        double needed_epochs = ConvergenceModel::create()->get_epochs_to_reach(Constants::END_CONDITION_TARGET_ACCURACY);
+        xbt_assert(!isinf(needed_epochs), "Accuracy %f can never be reached", Constants::END_CONDITION_TARGET_ACCURACY);
+
+        number_rounds = ceil(needed_epochs / this->get_effective_epochs_per_round(root));
+    }
+    else if (Constants::END_CONDITION_ENERGY_BUDGET != 0.0)
+    {
+        double round_energy = result.get_total_consumption();
+        xbt_assert(round_energy > 0.0, "Energy budget %f can never be exhausted", Constants::END_CONDITION_ENERGY_BUDGET);
+
+        number_rounds = Constants::END_CONDITION_ENERGY_BUDGET / round_energy;
+    }
+    else
+    {
+        xbt_die("No END_CONDITION have been defined");
+    }
+
+    XBT_INFO("Estimated round time: %f s, number of rounds: %f", round_time, number_rounds);
+
+    result.simulation_time *= number_rounds;
+    result.total_host_consumption *= number_rounds;
+    result.used_host_consumption *= number_rounds;
+    result.idle_host_consumption *= number_rounds;
+    result.total_link_consumption *= number_rounds;
+    result.total_disk_consumption *= number_rounds;
+
+    return result;
+}
+
+SimulationResult estimate_simulation(const char *fried_path)
+{
+    return Estimator(fried_path).estimate();
+}
@@ -0,0 +1,27 @@
+#ifndef FALAFELS_ESTIMATE_HPP
+#define FALAFELS_ESTIMATE_HPP
+
+#include "result.hpp"
+
+/** Factors applied by SimGrid's LV08 network model */
+constexpr double LATENCY_FACTOR = 13.01;
+constexpr double BANDWIDTH_FACTOR = 0.97;
+
+/**
+ * Closed-form prediction of the outcome of a simulation, computed in milliseconds to pre-screen configurations.
+ * The platform has to be loaded beforehand, and the constants initialized from the same fried file.
+ *
+ * A round is predicted from the cost formulas of the Trainer and the Aggregator, and from the routes between nodes
+ * following SimGrid's default network model (LV08): latencies are multiplied by 13.01, bandwidths by 0.97, flows
+ * share links with max-min fairness and are bounded by the TCP window. Energy follows from the wattage_per_state
+ * of hosts and the wattage_range of links.
+ *
+ * Training costs are scaled by the dataset size of each trainer, and trainers reading their shard before every epoch
+ * (without Constants::DATASET_PAGE_CACHE) add the time and energy of their reads. With the page cache, the single
+ * cold read of each shard is ignored.
+ *
+ * Only star clusters and aggregation trees are supported. Registration and kill phases are ignored.
+ */
+SimulationResult estimate_simulation(const char *fried_path);
+
+#endif // !FALAFELS_ESTIMATE_HPP
@@ -4,49 +4,194 @@
 #include <simgrid/s4u/Actor.hpp>
 #include <simgrid/s4u/Engine.hpp>
 #include <simgrid/s4u/Mailbox.hpp>
+#include <format>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 #include <xbt/log.h>
 
 #include "config_loader.hpp"
 #include "dot.hpp"
+#include "estimate.hpp"
 #include "node/node.hpp"
+#include "node/roles/trainer/trainer.hpp"
+#include "placement.hpp"
+#include "platform.hpp"
+#include "profiler.hpp"
+#include "result.hpp"
+#include "trace_replay.hpp"
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_main, "Messages specific for this example");
 
 int main(int argc, char* argv[])
 {
+    // Remove our own flags from argv, leaving SimGrid's flags and the positional arguments
+    std::string threads_cfg;
+    std::optional<std::string> cache_dir;
+    bool force_rerun = false;
+    bool estimate = false;
+    std::optional<std::string> profile_dir;
+    std::optional<std::string> optimized_deployment;
+    std::optional<std::string> trace_path;
+    bool replay = false;
+    std::vector<std::string> cfg_flags;
+
+    int nb_args = 1;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string_view arg(argv[i]);
+
+        if (arg.starts_with("--threads="))
+        {
+            // Shortcut for SimGrid's parallel contexts, consumed by the Engine as any --cfg flag
+            threads_cfg = std::format("--cfg=contexts/nthreads:{}", arg.substr(std::string_view("--threads=").size()));
+            argv[nb_args++] = threads_cfg.data();
+            cfg_flags.push_back(threads_cfg);
+        }
+        else if (arg.starts_with("--cache-dir="))
+            cache_dir = std::string(arg.substr(std::string_view("--cache-dir=").size()));
+        else if (arg == "--force-rerun")
+            force_rerun = true;
+        else if (arg == "--estimate")
+            estimate = true;
+        else if (arg.starts_with("--profile="))
+            profile_dir = std::string(arg.substr(std::string_view("--profile=").size()));
+        else if (arg.starts_with("--optimize-deployment="))
+            optimized_deployment = std::string(arg.substr(std::string_view("--optimize-deployment=").size()));
+        else if (arg.starts_with("--record-trace="))
+            trace_path = std::string(arg.substr(std::string_view("--record-trace=").size()));
+        else if (arg == "--replay")
+            replay = true;
+        else
+        {
+            // SimGrid options may change the outcome of the simulation, so they are part of the cache key
+            if (arg.starts_with("--cfg="))
+                cfg_flags.push_back(std::string(arg));
+
+            argv[nb_args++] = argv[i];
+        }
+    }
+    argc = nb_args;
+
     simgrid::s4u::Engine e(&argc, argv);
 
-    // Initializing host and link energy plugins
+    xbt_assert(argc > 2, "Usage: %s platform_file deployment_file [--threads=N] [--cache-dir=DIR [--force-rerun]] [--estimate] [--profile=DIR] [--optimize-deployment=FILE] [--record-trace=FILE] [--replay]\n", argv[0]);
+
+    // Predict the result in closed form instead of simulating, only the platform and constants are needed
+    if (estimate)
+    {
+        load_platform(argv[1]);
+        load_constants(argv[2]);
+
+        estimate_simulation(argv[2]).print("estimated");
+        return 0;
+    }
+
+    // Rewrite the deployment after the routes of the platform instead of simulating it
+    if (optimized_deployment)
+    {
+        load_platform(argv[1]);
+        load_constants(argv[2]);
+
+        optimize_deployment(argv[2], optimized_deployment->c_str());
+        return 0;
+    }
+
+    // Replay a trace recorded with --record-trace, given instead of the deployment, without running the Nodes
+    if (replay)
+    {
+        sg_host_energy_plugin_init();
+        sg_link_energy_plugin_init();
+        sg_disk_energy_plugin_init();
+
+        load_platform(argv[1]);
+        SimulationResult::set_used_hosts(replay_trace(argv[2]));
+
+        e.run();
+
+        SimulationResult::collect().print("replayed");
+        return 0;
+    }
+
+    // Identical inputs always lead to the same result, so we can skip the simulation if it already ran
+    std::optional<ResultCache> cache;
+    if (cache_dir)
+    {
+        cache.emplace(*cache_dir, argv[1], argv[2], cfg_flags);
+
+        // Profiles and traces are only produced by running the simulation, a cached result can't provide them
+        bool needs_run = force_rerun || profile_dir || trace_path;
+
+        if (auto cached_result = cache->lookup(); cached_result && !needs_run)
+        {
+            cached_result->print("cached");
+            return 0;
+        }
+    }
+
+    // Initializing host, link and disk energy plugins
     sg_host_energy_plugin_init();
     sg_link_energy_plugin_init();
-
-    xbt_assert(argc > 2, "Usage: %s platform_file deployment_file\n", argv[0]);
+    sg_disk_energy_plugin_init();
 
     /* Load the platform description and then deploy the application */
-    e.load_platform(argv[1]);
+    load_platform(argv[1]);
 
     // Using our own deployment function instead of simgrid's one
     // e.load_deployment(argv[2]);
 
     auto nodes_map = load_config(argv[2]); 
 
+    if (profile_dir)
+        PhaseProfiler::get_instance().enable(*profile_dir);
+
+    if (trace_path)
+        TraceRecorder::get_instance().enable(*trace_path);
+
+    // From now on, actors may read constants from several threads at once
+    Constants::freeze();
+
+    std::vector<std::string> used_hosts;
+
     for (auto [name, node] : *nodes_map)
     {
+        used_hosts.push_back(name);
         XBT_INFO("Initializing node '%s'", name.c_str());
         node->run();
         delete node;
     }
 
+    SimulationResult::set_used_hosts(used_hosts);
+
+    size_t number_actors = e.get_actor_count();
+
     /* Run the simulation */
     e.run();
 
     if (Constants::GENERATE_DOT_FILES)
         DOTGenerator::get_instance().generate_state_files();
 
+    if (profile_dir)
+        PhaseProfiler::get_instance().generate_profile();
+
+    if (trace_path)
+        TraceRecorder::get_instance().save();
+
     delete nodes_map;
 
     XBT_INFO("Simulation is over");
+    XBT_INFO("Simulation statistics: actors=%zu packets=%lu", number_actors, protocol::Packet::get_total_packet_number());
+
+    if (Constants::TRAINER_SLEEP_PSTATE >= 0)
+        XBT_INFO("Idle energy avoided by sleeping trainers: %f J", Trainer::get_total_avoided_idle_energy());
+
+    auto result = SimulationResult::collect();
+    result.apply_extrapolation();
+    result.print();
+
+    if (cache)
+        cache->store(result);
 
     return 0;
 }
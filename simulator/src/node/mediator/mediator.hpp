@@ -1,7 +1,10 @@
 #ifndef FALAFELS_MEDIATOR_HPP
 #define FALAFELS_MEDIATOR_HPP
 
+#include <deque>
 #include <format>
+#include <functional>
+#include <memory>
 #include <simgrid/forward.h>
 #include <simgrid/s4u/MessageQueue.hpp>
 #include <simgrid/s4u/ActivitySet.hpp>
@@ -26,10 +29,24 @@ public:
 
     using Event = std::variant<NodeConnected, ClusterConnected>; 
 
-    void wait_all_async_comms()
+    /**
+     * In-memory hand-off used instead of the received operations and events MessageQueues when the Role and the
+     * NetworkManager of a Node share the same actor. Because the NetworkManager doesn't run on its own anymore, 
+     * the Role steps it whenever it has to wait for something.
+     */
+    struct DirectChannel
     {
-        this->async_messages->wait_all();
-    }
+        std::deque<protocol::operations::Operation> received_operations;
+        std::deque<Event> nm_events;
+
+        /** Run one step of the NetworkManager */
+        std::function<void()> step_network_manager;
+
+        /** Make the NetworkManager return from its step when the given activity completes */
+        std::function<void(simgrid::s4u::ActivityPtr)> watch_activity;
+    };
+
+    void set_direct_channel(std::shared_ptr<DirectChannel> channel) { this->channel = channel; }
 protected:
     /** 
      * Initialize queues to enable communication between Role and NetworkManager.
@@ -56,6 +73,9 @@ protected:
     simgrid::s4u::MessageQueue *mq_nm_events;
 
     simgrid::s4u::ActivitySet *async_messages;
+
+    /** Set when the Role and the NetworkManager share the same actor, see DirectChannel */
+    std::shared_ptr<DirectChannel> channel;
 };
 
 #endif // !FALAFELS_MEDIATOR_HPP
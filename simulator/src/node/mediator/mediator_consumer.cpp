@@ -1,6 +1,8 @@
 #include "mediator_consumer.hpp"
 #include <xbt/log.h>
 
+#include "../../trace_replay.hpp"
+
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_mediator_consumer, "Messages specific for this example");
 
@@ -9,23 +11,121 @@ using namespace protocol;
 
 unique_ptr<operations::Operation> MediatorConsumer::get_received_operation()
 {
-    return this->mq_received_operations->get_unique<operations::Operation>();
+    unique_ptr<operations::Operation> op;
+
+    if (!this->channel)
+    {
+        op = this->mq_received_operations->get_unique<operations::Operation>();
+    }
+    else
+    {
+        while (this->channel->received_operations.empty())
+            this->channel->step_network_manager();
+
+        op = make_unique<operations::Operation>(this->channel->received_operations.front());
+        this->channel->received_operations.pop_front();
+    }
+
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_wait(this->mq_received_operations);
+
+    return op;
 }
 
 void MediatorConsumer::put_to_be_sent_packet(filters::NodeFilter filter, const operations::Operation op)
 {
     auto p = new Packet(filter, op);
-    this->mq_to_be_sent_packets->put(p);
+
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_notify(this->mq_to_be_sent_packets);
+
+    if (!this->channel)
+    {
+        this->mq_to_be_sent_packets->put(p);
+        return;
+    }
+
+    // A blocking put would never be matched as the NetworkManager runs in our actor
+    auto mess = this->mq_to_be_sent_packets->put_async(p);
+    while (!mess->test())
+        this->channel->step_network_manager();
 }
 
 void MediatorConsumer::put_async_to_be_sent_packet(filters::NodeFilter filter, const operations::Operation op)
 {
     auto p = new Packet(filter, op);
+
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_notify(this->mq_to_be_sent_packets);
+
     auto mess = this->mq_to_be_sent_packets->put_async(p);
     this->async_messages->push(mess);
 }
 
 unique_ptr<Mediator::Event> MediatorConsumer::get_nm_event()
 {
-    return this->mq_nm_events->get_unique<Event>();
+    unique_ptr<Event> e;
+
+    if (!this->channel)
+    {
+        e = this->mq_nm_events->get_unique<Event>();
+    }
+    else
+    {
+        while (this->channel->nm_events.empty())
+            this->channel->step_network_manager();
+
+        e = make_unique<Event>(this->channel->nm_events.front());
+        this->channel->nm_events.pop_front();
+    }
+
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_wait(this->mq_nm_events);
+
+    return e;
+}
+
+void MediatorConsumer::wait_all_async_comms()
+{
+    if (!this->channel)
+    {
+        this->async_messages->wait_all();
+        return;
+    }
+
+    // The NetworkManager has to be stepped for our puts to be received
+    while (!this->async_messages->empty())
+    {
+        this->channel->step_network_manager();
+
+        while (this->async_messages->test_any() != nullptr);
+    }
+}
+
+void MediatorConsumer::wait_activities(simgrid::s4u::ActivitySet *activities)
+{
+    if (!this->channel)
+    {
+        activities->wait_all();
+        return;
+    }
+
+    // Keep handling the network while our activities are running
+    for (unsigned i = 0; i < activities->size(); i++)
+        this->channel->watch_activity(activities->at(i));
+
+    auto all_done = [activities]()
+    {
+        for (unsigned i = 0; i < activities->size(); i++)
+        {
+            if (!activities->at(i)->test())
+                return false;
+        }
+        return true;
+    };
+
+    while (!all_done())
+        this->channel->step_network_manager();
+
+    activities->clear();
 }
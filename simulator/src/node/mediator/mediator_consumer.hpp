@@ -30,6 +30,12 @@ public:
 
     /** Blocking get for retrieving a NetworkManager Event */
     std::unique_ptr<Event> get_nm_event();
+
+    /** Wait until every async put has been received by the NetworkManager */
+    void wait_all_async_comms();
+
+    /** Wait for the completion of activities started by the Role, such as training or aggregating tasks */
+    void wait_activities(simgrid::s4u::ActivitySet *activities);
 };
 
 #endif // !FALAFELS_MEDIATOR_CONSUMER_HPP
@@ -1,5 +1,7 @@
 #include "mediator_producer.hpp"
 
+#include "../../trace_replay.hpp"
+
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_mediator_producer, "Messages specific for this example");
 
@@ -12,6 +14,9 @@ shared_ptr<Packet> MediatorProducer::get_to_be_sent_packet()
     auto res = std::make_shared<Packet>(*tmp);
     delete tmp;
 
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_wait(this->mq_to_be_sent_packets);
+
     return res;
 }
 
@@ -20,9 +25,26 @@ simgrid::s4u::MessPtr MediatorProducer::get_async_to_be_sent_packet()
     return this->mq_to_be_sent_packets->get_async();
 }
 
+unique_ptr<Packet> MediatorProducer::take_to_be_sent_packet(const simgrid::s4u::MessPtr &mess)
+{
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_wait(this->mq_to_be_sent_packets);
+
+    return unique_ptr<Packet>((Packet *) mess->get_payload());
+}
+
 
 void MediatorProducer::put_received_operation(const operations::Operation op)
 {
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_notify(this->mq_received_operations);
+
+    if (this->channel)
+    {
+        this->channel->received_operations.push_back(op);
+        return;
+    }
+
     auto mess = this->mq_received_operations->put_async(
         new operations::Operation(op) // Create heap allocated object
     );
@@ -32,6 +54,16 @@ void MediatorProducer::put_received_operation(const operations::Operation op)
 
 void MediatorProducer::put_nm_event(Event *e)
 {
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_notify(this->mq_nm_events);
+
+    if (this->channel)
+    {
+        this->channel->nm_events.push_back(*e);
+        delete e;
+        return;
+    }
+
     auto mess = this->mq_nm_events->put_async(e);
     this->async_messages->push(mess);
 }
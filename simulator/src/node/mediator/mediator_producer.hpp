@@ -25,6 +25,9 @@ public:
     /** Async get for retrieving a packet to be sent */
     simgrid::s4u::MessPtr get_async_to_be_sent_packet();
 
+    /** Packet of a completed get_async_to_be_sent_packet() */
+    std::unique_ptr<protocol::Packet> take_to_be_sent_packet(const simgrid::s4u::MessPtr &mess);
+
     /** Async put an operation received by the network */
     void put_received_operation(const protocol::operations::Operation op);
 
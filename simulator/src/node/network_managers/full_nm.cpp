@@ -154,5 +154,8 @@ void FullyConnectedNetworkManager::handle_kill_phase()
 {
     // Wait to sent to kill packet to everyone on the network
     if (this->my_node_info.role == NodeRole::MainAggregator)
+    {
         this->pending_async_put->wait_all();
+        this->join_chunk_senders();
+    }
 }
@@ -45,7 +45,8 @@ void HierarchicalNetworkManager::run()
                     this->state = WAITING_REGISTRATION_REQUEST;
                     break;
                 case NodeRole::Aggregator:
-                    xbt_die("The HierarchicalNetworkManager can't have a secondary Aggregator, only a Main one.");
+                    xbt_die("The HierarchicalNetworkManager can't have a secondary Aggregator, only a Main one. "
+                            "Intermediate aggregators of the tree join their parent through a parent link.");
                     break;
             }
             break;
@@ -100,23 +101,23 @@ void HierarchicalNetworkManager::run()
                     // Reload Comm aysnc get for next run, because the previous one is deleted by wait_any()
                     this->pending_comm_and_mess_get->push(this->get_async());
 
-                    auto p = std::unique_ptr<Packet>((Packet *) comm->get_payload());
+                    auto p = this->take_received_packet(comm);
 
                     // Can we handle this log better? is it possible to print it with a callback maybe?
                     XBT_INFO("%s <--%s(%lu)--- %s", p->dst.c_str(), p->get_op_name(), p->id, p->src.c_str());
 
-                    // Only the trainer (The hierarchical aggregators under a fake identity) can receive a Kill
+                    // Kills come from our parent: either we are a parent link and redirect it to our owner, or we are an
+                    // intermediate aggregator of the tree and pass it down to our children.
                     if (auto *kill = get_if<operations::Kill>(&p->op))
                     {
                         this->state = KILLING;
                         this->clear_async_puts();
 
-                        // Redirect to the main node upon receiving kill
-                        std::string hierarchical_aggregator_name = this->my_node_info.name;
-                        replace_first(hierarchical_aggregator_name, "hierarchical_", "");
-                        p->dst = hierarchical_aggregator_name;
-                        this->send_async(p, true);
-                        break;
+                        this->forward_kill(p);
+
+                        // Parent links don't have any Role to notify
+                        if (this->is_parent_link())
+                            break;
                     }
 
                     this->if_target_put_op(std::move(p));
@@ -127,7 +128,7 @@ void HierarchicalNetworkManager::run()
                     // Reload Mess aysnc get for next run, because the previous one is deleted by wait_any()
                     this->pending_comm_and_mess_get->push(this->mp->get_async_to_be_sent_packet());
 
-                    auto p = std::unique_ptr<Packet>((Packet *) mess->get_payload());
+                    auto p = this->mp->take_to_be_sent_packet(mess);
 
                     // Case where we send kill to someone else
                     if (auto *kill = get_if<operations::Kill>(&p->op))
@@ -136,8 +137,8 @@ void HierarchicalNetworkManager::run()
                         this->clear_async_puts();
                     }
 
-                    // Send to Central Aggregator if we're hierarchical node
-                    // Or send to hierarchical nodes if we're the Central Aggregator
+                    // Send to our parent if we're a parent link
+                    // Or send to our children if we're the head of the cluster
                     this->broadcast(p);
                 }
                 break;
@@ -244,8 +245,9 @@ void HierarchicalNetworkManager::handle_kill_phase()
 {
     // Wait to sent to kill packet to everyone on the network
     // This includes:
-    // Central NM -> Hierarchical NM 
+    // Parent NM -> Parent link NM 
     // and 
-    // Hierarchical NM -> real NM
+    // Parent link NM -> Owner's cluster NM
     this->pending_async_put->wait_all();
+    this->join_chunk_senders();
 }
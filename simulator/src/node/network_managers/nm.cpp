@@ -17,6 +17,9 @@
 
 #include "../../utils/utils.hpp"
 #include "../../dot.hpp"
+#include "../../profiler.hpp"
+#include "../../symmetry.hpp"
+#include "../../trace_replay.hpp"
 
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_network_manager, "Messages specific for this example");
@@ -53,11 +56,28 @@ unique_ptr<Packet> NetworkManager::get(const optional<double> timeout)
     unique_ptr<Packet> p;
 
     if (timeout.has_value())
-        p = this->mailbox->get_unique<Packet>(*timeout);
+    {
+        try
+        {
+            p = this->mailbox->get_unique<Packet>(*timeout);
+        }
+        catch (simgrid::TimeoutException &)
+        {
+            // Replays wait as long, e.g. until the end of the registration phase
+            if (TraceRecorder::get_instance().is_enabled())
+                TraceRecorder::get_instance().record_sleep(*timeout);
+
+            throw;
+        }
+    }
     else
         p = this->mailbox->get_unique<Packet>();
 
     XBT_INFO("%s <--%s(%lu)--- %s", p->dst.c_str(), p->get_op_name(), p->id, p->src.c_str());
+
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_reception(*p, this->get_my_node_name());
+
     return p;
 }
 
@@ -66,25 +86,36 @@ simgrid::s4u::CommPtr NetworkManager::get_async()
     return this->mailbox->get_async();
 }
 
-void NetworkManager::send_async(const std::unique_ptr<Packet> &p, bool is_redirected)
+unique_ptr<Packet> NetworkManager::take_received_packet(const simgrid::s4u::CommPtr &comm)
+{
+    auto p = unique_ptr<Packet>((Packet *) comm->get_payload());
+
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_reception(*p, this->get_my_node_name());
+
+    return p;
+}
+
+Packet *NetworkManager::prepare_send(const std::unique_ptr<Packet> &p, bool is_redirected)
 {
     auto p_clone = p->clone();
     p_clone->src = this->get_my_node_name();
     p_clone->dst = p->dst;
+    p_clone->hop_send_time = simgrid::s4u::Engine::get_instance()->get_clock();
 
     // Only write original source when sending packets created by the current node.
     if (!is_redirected)
     {
         p_clone->original_src = this->get_my_node_name();
-        XBT_INFO("%s ---%s(%lu)--> %s", p_clone->src.c_str(), p_clone->get_op_name(), p_clone->id, p_clone->dst.c_str());
+        p_clone->send_time = p_clone->hop_send_time;
     }
     else
     {
         p_clone->original_src = p->original_src;
-        XBT_INFO("%s ---%s(%lu)--> %s [REDIRECT]", p_clone->src.c_str(), p_clone->get_op_name(), p_clone->id, p_clone->dst.c_str());
     }
 
-    auto receiver_mailbox = simgrid::s4u::Mailbox::by_name(p_clone->dst);
+    if (PhaseProfiler::get_instance().is_enabled())
+        PhaseProfiler::get_instance().register_host(this->get_my_node_name(), simgrid::s4u::this_actor::get_host());
 
     if (Constants::GENERATE_DOT_FILES)
     {
@@ -94,6 +125,25 @@ void NetworkManager::send_async(const std::unique_ptr<Packet> &p, bool is_redire
         );
     }
 
+    return p_clone;
+}
+
+void NetworkManager::send_async(const std::unique_ptr<Packet> &p, bool is_redirected)
+{
+    auto p_clone = this->prepare_send(p, is_redirected);
+
+    if (!is_redirected)
+        XBT_INFO("%s ---%s(%lu)--> %s", p_clone->src.c_str(), p_clone->get_op_name(), p_clone->id, p_clone->dst.c_str());
+    else
+        XBT_INFO("%s ---%s(%lu)--> %s [REDIRECT]", p_clone->src.c_str(), p_clone->get_op_name(), p_clone->id, p_clone->dst.c_str());
+
+    auto receiver_mailbox = simgrid::s4u::Mailbox::by_name(p_clone->dst);
+
+    if (Constants::SYMMETRY_REDUCTION)
+        this->mirror_to_shadows(p_clone);
+
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_send(*p_clone);
 
     auto comm = receiver_mailbox->put_async(p_clone, p_clone->get_packet_size());
 
@@ -102,12 +152,106 @@ void NetworkManager::send_async(const std::unique_ptr<Packet> &p, bool is_redire
     this->pending_async_put->push(comm);
 }
 
+void NetworkManager::mirror_to_shadows(Packet *p)
+{
+    auto &symmetry = SymmetryReduction::get_instance();
+    auto my_host = simgrid::s4u::this_actor::get_host();
+
+    // Packets sent by a representative are also sent by its shadows
+    for (auto shadow_host : symmetry.get_shadow_hosts(this->get_my_node_name()))
+    {
+        auto dst_host = simgrid::s4u::Engine::get_instance()->host_by_name(p->dst);
+        this->pending_async_put->push(simgrid::s4u::Comm::sendto_async(shadow_host, dst_host, p->get_packet_size()));
+    }
+
+    // And packets sent to a representative are also sent to its shadows
+    for (auto shadow_host : symmetry.get_shadow_hosts(p->dst))
+    {
+        this->pending_async_put->push(simgrid::s4u::Comm::sendto_async(my_host, shadow_host, p->get_packet_size()));
+    }
+}
+
+void NetworkManager::send_async_chunked(const std::unique_ptr<Packet> &p, bool is_redirected)
+{
+    const uint64_t chunk_size = Constants::MODEL_CHUNK_SIZE_BYTES;
+    const uint64_t packet_size = p->get_packet_size();
+
+    // Chunks are relayed as they are, and packets that fit in one chunk aren't split
+    if (chunk_size == 0 || p->nb_chunks > 1 || packet_size <= chunk_size)
+    {
+        this->send_async(p, is_redirected);
+        return;
+    }
+
+    const uint32_t nb_chunks = (packet_size + chunk_size - 1) / chunk_size;
+    auto chunks = make_shared<vector<Packet*>>();
+
+    for (uint32_t i = 0; i < nb_chunks; i++)
+    {
+        auto chunk = this->prepare_send(p, is_redirected);
+        // The last chunk carries the remaining bytes
+        chunk->set_chunk(i, nb_chunks, i == nb_chunks - 1 ? packet_size - chunk_size * i : chunk_size);
+        chunks->push_back(chunk);
+
+        // Replayed as if they were all sent at once, as the actor sending them isn't part of the trace
+        if (TraceRecorder::get_instance().is_enabled())
+            TraceRecorder::get_instance().record_send(*chunk);
+    }
+
+    XBT_INFO("%s ---%s(%lu)--> %s [%u CHUNKS]", this->get_my_node_name().c_str(), p->get_op_name(), p->id, p->dst.c_str(), nb_chunks);
+
+    auto receiver_mailbox = simgrid::s4u::Mailbox::by_name(p->dst);
+
+    // Chunks have to be sent one after the other for the next hop to start forwarding the first ones while the
+    // following are still on their way, so a dedicated actor performs the blocking puts.
+    // It is a daemon so that a transfer interrupted by the end of the simulation doesn't keep it running.
+    auto sender = simgrid::s4u::Actor::create(
+        std::format("{}_chunks_{}", this->get_my_node_name(), p->id),
+        simgrid::s4u::this_actor::get_host(),
+        [receiver_mailbox, chunks]()
+        {
+            try
+            {
+                for (auto chunk : *chunks)
+                    receiver_mailbox->put(chunk, chunk->get_packet_size());
+            }
+            // The receiver failed, the following chunks are lost as well
+            catch (simgrid::NetworkFailureException &)
+            {
+            }
+        }
+    )->daemonize();
+
+    // Forget about the senders that completed
+    erase_if(this->chunk_senders, [](const auto &s) { return !simgrid::s4u::Actor::by_pid(s.second); });
+
+    this->chunk_senders.emplace_back(p->dst, sender->get_pid());
+}
+
+bool NetworkManager::join_chunk_senders(const optional<double> timeout)
+{
+    for (auto &[_, pid] : this->chunk_senders)
+    {
+        if (auto sender = simgrid::s4u::Actor::by_pid(pid))
+        {
+            if (timeout)
+                sender->join(*timeout);
+            else
+                sender->join();
+        }
+    }
+
+    erase_if(this->chunk_senders, [](const auto &s) { return !simgrid::s4u::Actor::by_pid(s.second); });
+
+    return this->chunk_senders.empty();
+}
+
 void NetworkManager::kill_role_actor()
 {
     std::string my_node_name = this->my_node_info.name;
 
-    // Ignore because hierarchical_nm doesn't have any associated role
-    if (my_node_name.contains("hierarchical_")) return;
+    // Ignore because parent links don't have any associated role
+    if (this->is_parent_link()) return;
 
     // Get the actors running on the current host
     auto actors = simgrid::s4u::Engine::get_instance()->host_by_name(my_node_name)->get_all_actors();
@@ -123,16 +267,101 @@ void NetworkManager::kill_role_actor()
     }
 }
 
+void NetworkManager::forward_kill(const unique_ptr<Packet> &p)
+{
+    if (this->is_parent_link())
+    {
+        // Redirect to the NetworkManager of the cluster we belong to
+        p->dst = *this->parent_link_owner;
+        this->send_async(p, true);
+    }
+    else
+    {
+        this->broadcast(p);
+    }
+}
+
+void NetworkManager::recover_failed_receptions()
+{
+    while (this->pending_comm_and_mess_get->has_failed_activities())
+        this->pending_comm_and_mess_get->get_failed_activity();
+
+    // Only the reception from the network can fail, reload it if it was the one
+    for (unsigned i = 0; i < this->pending_comm_and_mess_get->size(); i++)
+    {
+        if (boost::dynamic_pointer_cast<simgrid::s4u::Comm>(this->pending_comm_and_mess_get->at(i)))
+            return;
+    }
+
+    this->pending_comm_and_mess_get->push(this->get_async());
+}
+
+void NetworkManager::cancel_async_puts_to(const node_name &dst)
+{
+    vector<simgrid::s4u::ActivityPtr> puts_to_dst;
+
+    // Puts are named after their receiver
+    for (unsigned i = 0; i < this->pending_async_put->size(); i++)
+    {
+        if (this->pending_async_put->at(i)->get_name() == dst)
+            puts_to_dst.push_back(this->pending_async_put->at(i));
+    }
+
+    for (auto put : puts_to_dst)
+    {
+        put->cancel();
+        this->pending_async_put->erase(put);
+    }
+
+    // Killing a chunk sender cancels the put it is blocked in
+    for (auto &[sender_dst, pid] : this->chunk_senders)
+    {
+        if (auto sender = simgrid::s4u::Actor::by_pid(pid); sender && sender_dst == dst)
+            sender->kill();
+    }
+
+    erase_if(this->chunk_senders, [&dst](const auto &s) { return s.first == dst; });
+}
+
 void NetworkManager::if_target_put_op(unique_ptr<Packet> p)
 {
+    // Chunks only reach the Role once the whole packet has been received
+    if (!p->is_last_chunk())
+        return;
+
+    // Every hop is recorded, so that the critical path can go through relays
+    if (PhaseProfiler::get_instance().is_enabled())
+        PhaseProfiler::get_instance().record_transfer(*p, this->get_my_node_name());
+
     // Check if the packet is targeted to our node's role
     if ((*p->target_filter)(&this->my_node_info))
     {
+        if (PhaseProfiler::get_instance().is_enabled())
+            this->profile_reception(p);
+
         // If so, put the packet's operation
         this->mp->put_received_operation(p->op);
     }
 }
 
+void NetworkManager::profile_reception(const unique_ptr<Packet> &p)
+{
+    auto &profiler = PhaseProfiler::get_instance();
+    double now = simgrid::s4u::Engine::get_instance()->get_clock();
+
+    if (holds_alternative<operations::SendLocalModel>(p->op))
+    {
+        profiler.record_upload(p->original_src, this->get_my_node_name(), p->send_time, now);
+    }
+    else if (holds_alternative<operations::SendGlobalModel>(p->op))
+    {
+        // Receiving a global model starts a new round, and the broadcast of the sender lasts until its last reception
+        profiler.start_round(this->get_my_node_name());
+        profiler.record(this->get_my_node_name(), PhaseProfiler::BROADCAST, p->send_time, now);
+        profiler.record(p->original_src, PhaseProfiler::BROADCAST, p->send_time, now);
+    }
+}
+
 void NetworkManager::init_run_activities()
 {
     // Initialize the first waiting activities: this should be done one time before going into RUNNING state
@@ -151,4 +380,7 @@ void NetworkManager::clear_async_puts()
 
     // Clear all async put before sending and waiting the kill packet
     this->pending_async_put->clear();
+
+    // Chunk senders are daemons, so they are detached as well
+    this->chunk_senders.clear();
 }
@@ -50,8 +50,38 @@ protected:
     /** AcitivitySet for all put communications made by our node */
     simgrid::s4u::ActivitySet *pending_async_put;
 
+    /** 
+     * Actors sending the chunks of a packet one after the other, with the receiver of the packet, see
+     * send_async_chunked(). Covered as pending_async_put by the kill phase, clear_async_puts() and cancel_async_puts_to().
+     */
+    std::vector<std::pair<protocol::node_name, aid_t>> chunk_senders;
+
     /** AcitivitySet regrouping communications (from others NetworkManager) and messages (from our Role) */
     simgrid::s4u::ActivitySet *pending_comm_and_mess_get;
+
+    /** 
+     * Name of the Node owning this NetworkManager when it is used as a parent link, i.e. the connection of an
+     * intermediate aggregator to its parent in the aggregation tree. Empty for regular NetworkManagers.
+     */
+    std::optional<protocol::node_name> parent_link_owner;
+
+    /**
+     * Forward a Kill received from the network: a parent link hands it over to the NetworkManager of its owner,
+     * any other NetworkManager spreads it to its own cluster.
+     */
+    void forward_kill(const std::unique_ptr<protocol::Packet> &p);
+
+    /** Forget about the receptions that failed because their sender failed, and receive packets again */
+    void recover_failed_receptions();
+
+    /** Cancel our pending puts to a node that departed, so that they don't wait for it forever */
+    void cancel_async_puts_to(const protocol::node_name &dst);
+
+    /** 
+     * Wait for the chunk senders to send their last chunk, for at most timeout seconds each if given.
+     * Returns whether they all completed.
+     */
+    bool join_chunk_senders(const std::optional<double> timeout=std::nullopt);
 public:  
     NetworkManager(protocol::NodeInfo node_info);
     virtual ~NetworkManager();
@@ -66,24 +96,42 @@ public:
 
     /** Set bootstrap_nodes */
     void set_bootstrap_nodes(std::vector<protocol::NodeInfo> *nodes);
+
+    /** Use this NetworkManager as the parent link of the given Node, see parent_link_owner */
+    void set_parent_link_owner(protocol::node_name owner) { this->parent_link_owner = owner; }
+
+    /** Whether this NetworkManager is a parent link, in which case no Role is attached to it */
+    bool is_parent_link() { return this->parent_link_owner.has_value(); }
  
     /** Classic send from the current node to another one. If is_redirected is set to true, the original source wont be overwritten */
     void send_async(const std::unique_ptr<protocol::Packet> &p, bool is_redirected=false);
 
+    /** 
+     * Same as send_async, but splits packets bigger than MODEL_CHUNK_SIZE_BYTES into chunks sent one after the other.
+     * Chunks themselves are sent as a whole, so that relays forward them as soon as they arrive.
+     */
+    void send_async_chunked(const std::unique_ptr<protocol::Packet> &p, bool is_redirected=false);
+
     void kill_role_actor();
 
-    /** Blocking get a Packet from the Network */
+    /** Blocking get a Packet from the Network, throwing simgrid::TimeoutException once the timeout is over */
     std::unique_ptr<protocol::Packet> get(const std::optional<double> timeout=std::nullopt);
 
     /** Async get a Packet from the Network */
     simgrid::s4u::CommPtr get_async();
 
+    /** Packet of a completed get_async() */
+    std::unique_ptr<protocol::Packet> take_received_packet(const simgrid::s4u::CommPtr &comm);
+
     void init_run_activities();
 
     void clear_async_puts();
 
     void if_target_put_op(std::unique_ptr<protocol::Packet> p);
 
+    /** Return from the current run step when the given activity completes, used when the Role shares our actor */
+    void watch_activity(simgrid::s4u::ActivityPtr activity) { this->pending_comm_and_mess_get->push(activity); }
+
     /* --------- Methods to be redefined by children classes --------- */
     /** Run the main execution function of the NetworkManager */
     virtual void run() = 0;
@@ -107,6 +155,15 @@ public:
     virtual void handle_kill_phase() = 0;
     /* --------------------------------------------------------------- */
 private:
+    /** Send the transfers that the shadows of a representative would have made, see Constants::SYMMETRY_REDUCTION */
+    void mirror_to_shadows(protocol::Packet *p);
+
+    /** Record the transfer of a packet targeted to our Role, see PhaseProfiler */
+    void profile_reception(const std::unique_ptr<protocol::Packet> &p);
+
+    /** Clone a packet about to be sent by our node and fill its source fields */
+    protocol::Packet *prepare_send(const std::unique_ptr<protocol::Packet> &p, bool is_redirected);
+
     /** Simgrid mailbox associated to the NetworkManager */
     simgrid::s4u::Mailbox *mailbox; 
 };
@@ -10,7 +10,9 @@
 #include <simgrid/s4u/Engine.hpp>
 
 #include "ring_bi_nm.hpp"
+#include "../../constants.hpp"
 #include "../../dot.hpp"
+#include "../../placement.hpp"
 #include "nm.hpp"
 
 
@@ -92,7 +94,7 @@ void RingBiNetworkManager::run()
                     // Reload Comm aysnc get for next run, because the previous one is deleted by wait_any()
                     this->pending_comm_and_mess_get->push(this->get_async());
 
-                    auto p = std::unique_ptr<Packet>((Packet *) comm->get_payload());
+                    auto p = this->take_received_packet(comm);
 
                     // Can we handle this log better? is it possible to print it with a callback maybe?
                     XBT_INFO("%s <--%s(%lu)--- %s", p->dst.c_str(), p->get_op_name(), p->id, p->src.c_str());
@@ -123,7 +125,8 @@ void RingBiNetworkManager::run()
                             // Check if this global_model was originally sent by this Aggregator
                             if (p->original_src == this->get_my_node_name())
                             {
-                                if (!this->cluster_connected_have_been_sent)
+                                // Wait for the whole global model to have made the tour of the ring
+                                if (!this->cluster_connected_have_been_sent && p->is_last_chunk())
                                 {
                                     // We then know how much trainers were in the ring thanks to nb_hops
                                     XBT_INFO("Sending ClusterConnected");
@@ -159,7 +162,7 @@ void RingBiNetworkManager::run()
                     // Reload Mess aysnc get for next run, because the previous one is deleted by wait_any()
                     this->pending_comm_and_mess_get->push(this->mp->get_async_to_be_sent_packet());
 
-                    auto p = std::unique_ptr<Packet>((Packet *) mess->get_payload());
+                    auto p = this->mp->take_to_be_sent_packet(mess);
 
                     // Case where we send kill to someone else
                     if (auto *kill = get_if<operations::Kill>(&p->op))
@@ -205,6 +208,9 @@ void RingBiNetworkManager::handle_registration_requests()
         }
     }
 
+    if (Constants::RING_ORDER_BY_LATENCY)
+        order_ring_by_latency(this->get_my_node_name(), trainer_list);
+
     const uint32_t nb_trainers = trainer_list.size();
     // We, the MainAggregator already count for one
     const uint32_t nb_aggregators = 1 + aggregator_list.size();
@@ -314,7 +320,7 @@ void RingBiNetworkManager::handle_registration_confirmation(const operations::Re
 void RingBiNetworkManager::send_to_neighbour(const unique_ptr<Packet> &p, bool is_redirected) 
 {
     p->dst = this->left_node.name;
-    this->send_async(p, is_redirected);
+    this->send_async_chunked(p, is_redirected);
 }
 
 
@@ -323,4 +329,6 @@ void RingBiNetworkManager::handle_kill_phase()
     // Only wait if the last node isn't a MainAggregator, because this last will already be killed anyways
     if (this->pending_async_put->size() > 0)
         this->pending_async_put->wait_all();
+
+    this->join_chunk_senders();
 }
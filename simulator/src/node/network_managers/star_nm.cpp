@@ -8,6 +8,7 @@
 #include <ostream>
 #include <simgrid/Exception.hpp>
 #include <simgrid/s4u/Engine.hpp>
+#include <simgrid/s4u/Host.hpp>
 #include <simgrid/s4u/Mailbox.hpp>
 #include <variant>
 #include <vector>
@@ -63,6 +64,11 @@ void StarNetworkManager::run()
 
                     this->init_run_activities();
                 }
+                // A trainer recovering from a failure may rejoin after the end of the training
+                else if (holds_alternative<operations::Kill>(packet->op))
+                {
+                    this->state = KILLING;
+                }
                 break;
             }
         case WAITING_REGISTRATION_REQUEST:
@@ -95,7 +101,10 @@ void StarNetworkManager::run()
             }
         case RUNNING:
             {
-                auto activity = this->pending_comm_and_mess_get->wait_any();
+                auto activity = this->wait_activity();
+
+                if (!activity)
+                    break;
 
                 // If the activity has type Comm, it means we received a packet from the network
                 if (auto comm = boost::dynamic_pointer_cast<simgrid::s4u::Comm>(activity))
@@ -103,30 +112,26 @@ void StarNetworkManager::run()
                     // Reload Comm aysnc get for next run, because the previous one is deleted by wait_any()
                     this->pending_comm_and_mess_get->push(this->get_async());
 
-                    auto p = std::unique_ptr<Packet>((Packet *) comm->get_payload());
+                    auto p = this->take_received_packet(comm);
 
                     // Can we handle this log better? is it possible to print it with a callback maybe?
                     XBT_INFO("%s <--%s(%lu)--- %s", p->dst.c_str(), p->get_op_name(), p->id, p->src.c_str());
 
+                    // Trainers recovering from a failure register again
+                    if (auto *request = get_if<operations::RegistrationRequest>(&p->op))
+                    {
+                        this->handle_join(*request);
+                        break;
+                    }
+
                     // Case where we receive Kill
                     if (auto *kill = get_if<operations::Kill>(&p->op))
                     {
                         this->state = KILLING;
                         this->clear_async_puts();
 
-                        // Redirect to the main node upon receiving kill
-                        if (this->get_my_node_name().contains("hierarchical"))
-                        {
-                            std::string hierarchical_aggregator_name = this->my_node_info.name;
-                            replace_first(hierarchical_aggregator_name, "hierarchical_", "");
-                            p->dst = hierarchical_aggregator_name;
-                            this->send_async(p, true);
-                        }
-                        // main node receives the redirect from hierarchical Broadcast to everyone else
-                        else
-                        {
-                            this->broadcast(p);
-                        }
+                        // Parent links redirect to their owner, which then broadcasts to everyone else
+                        this->forward_kill(p);
                     }
 
                     this->if_target_put_op(std::move(p));
@@ -137,7 +142,7 @@ void StarNetworkManager::run()
                     // Reload Mess aysnc get for next run, because the previous one is deleted by wait_any()
                     this->pending_comm_and_mess_get->push(this->mp->get_async_to_be_sent_packet());
 
-                    auto p = std::unique_ptr<Packet>((Packet *) mess->get_payload());
+                    auto p = this->mp->take_to_be_sent_packet(mess);
 
                     // Case where we send kill to someone else
                     if (auto *kill = get_if<operations::Kill>(&p->op))
@@ -171,9 +176,12 @@ void StarNetworkManager::handle_registration_requests()
         );
     }
 
+    uint16_t number_client_connected = 0;
+
     for (auto request : *this->registration_requests)
     {
         this->connected_nodes->push_back(request.node_to_register); 
+        number_client_connected += request.node_to_register.multiplicity;
 
         if (Constants::GENERATE_DOT_FILES)
         {
@@ -188,26 +196,113 @@ void StarNetworkManager::handle_registration_requests()
             );
         }
 
-        auto node_list = vector<NodeInfo>();
-        node_list.push_back(this->my_node_info);
-
-        auto res_p = make_unique<Packet>(Packet(
-            request.node_to_register.name, request.node_to_register.name,
-            operations::RegistrationConfirmation(
-                make_shared<vector<NodeInfo>>(node_list)
-            )
-        ));
-
-        this->send_async(res_p);
+        this->send_registration_confirmation(request.node_to_register);
     }
 
     this->mp->put_nm_event(
         new Mediator::Event {
-            Mediator::ClusterConnected { .number_client_connected=(uint16_t)this->connected_nodes->size() }
+            Mediator::ClusterConnected { .number_client_connected=number_client_connected }
         }
     );
 }
 
+void StarNetworkManager::send_registration_confirmation(const NodeInfo &node)
+{
+    auto node_list = vector<NodeInfo>();
+    node_list.push_back(this->my_node_info);
+
+    auto res_p = make_unique<Packet>(Packet(
+        node.name, node.name,
+        operations::RegistrationConfirmation(
+            make_shared<vector<NodeInfo>>(node_list)
+        )
+    ));
+
+    this->send_async(res_p);
+}
+
+bool StarNetworkManager::watches_heartbeats()
+{
+    return Constants::CHURN_HEARTBEAT_PERIOD != 0.0 && this->my_node_info.role != NodeRole::Trainer;
+}
+
+simgrid::s4u::ActivityPtr StarNetworkManager::wait_activity()
+{
+    try
+    {
+        if (!this->watches_heartbeats())
+            return this->pending_comm_and_mess_get->wait_any();
+
+        double now = simgrid::s4u::Engine::get_instance()->get_clock();
+
+        if (now >= this->next_heartbeat_time)
+        {
+            this->check_heartbeats();
+            this->next_heartbeat_time = now + Constants::CHURN_HEARTBEAT_PERIOD;
+        }
+
+        return this->pending_comm_and_mess_get->wait_any_for(this->next_heartbeat_time - now);
+    }
+    catch (simgrid::TimeoutException &)
+    {
+        return nullptr;
+    }
+    catch (simgrid::NetworkFailureException &)
+    {
+        // The sender of the packet we were receiving failed
+        this->recover_failed_receptions();
+        return nullptr;
+    }
+}
+
+void StarNetworkManager::check_heartbeats()
+{
+    auto e = simgrid::s4u::Engine::get_instance();
+    vector<NodeInfo> departed_nodes;
+
+    // Heartbeats aren't simulated, only the state of the host they would have told us
+    for (auto &node : *this->connected_nodes)
+    {
+        if (!e->host_by_name(node.name)->is_on())
+            departed_nodes.push_back(node);
+    }
+
+    for (auto &node : departed_nodes)
+        this->handle_departure(node);
+}
+
+void StarNetworkManager::handle_departure(const NodeInfo &node)
+{
+    XBT_INFO("%s departed from the cluster", node.name.c_str());
+
+    erase_if(*this->connected_nodes, [&node](const NodeInfo &n) { return n.name == node.name; });
+    this->cancel_async_puts_to(node.name);
+
+    this->mp->put_received_operation(operations::MembershipChange { .node = node, .joined = false });
+}
+
+void StarNetworkManager::handle_join(const operations::RegistrationRequest &request)
+{
+    auto &node = request.node_to_register;
+
+    // The node failed and recovered between two checks
+    auto connected = find_if(this->connected_nodes->begin(), this->connected_nodes->end(), 
+                             [&node](const NodeInfo &n) { return n.name == node.name; });
+
+    if (connected != this->connected_nodes->end())
+    {
+        NodeInfo departed_node = *connected;
+        this->handle_departure(departed_node);
+    }
+
+    XBT_INFO("%s joins the cluster", node.name.c_str());
+
+    this->connected_nodes->push_back(node);
+    this->send_registration_confirmation(node);
+
+    this->mp->put_received_operation(operations::MembershipChange { .node = node, .joined = true });
+}
+
 void StarNetworkManager::send_registration_request()
 {
     // This assert is'nt true in the case of hierarchical aggregator...
@@ -251,6 +346,35 @@ void StarNetworkManager::broadcast(const unique_ptr<Packet> &p, bool is_redirect
 void StarNetworkManager::handle_kill_phase()
 {
     // Wait to sent to kill packet to everyone on the network
-    if (this->my_node_info.role != NodeRole::Trainer || this->get_my_node_name().contains("hierarchical_"))
+    if (this->my_node_info.role == NodeRole::Trainer && !this->is_parent_link())
+        return;
+
+    if (!this->watches_heartbeats())
+    {
         this->pending_async_put->wait_all();
+        this->join_chunk_senders();
+        return;
+    }
+
+    // Trainers may fail before receiving it
+    while (!this->pending_async_put->empty())
+    {
+        try
+        {
+            this->pending_async_put->wait_any_for(Constants::CHURN_HEARTBEAT_PERIOD);
+        }
+        catch (simgrid::TimeoutException &)
+        {
+            this->check_heartbeats();
+        }
+        catch (simgrid::NetworkFailureException &)
+        {
+            while (this->pending_async_put->has_failed_activities())
+                this->pending_async_put->get_failed_activity();
+        }
+    }
+
+    // Chunk senders to trainers that fail are killed by the heartbeat checks
+    while (!this->join_chunk_senders(Constants::CHURN_HEARTBEAT_PERIOD))
+        this->check_heartbeats();
 }
@@ -10,6 +10,26 @@ class StarNetworkManager : public NetworkManager
 {
 private:
     std::vector<protocol::NodeInfo> *connected_nodes;
+
+    /** Time of the next check of our trainers, see Constants::CHURN_HEARTBEAT_PERIOD */
+    double next_heartbeat_time = 0.0;
+
+    /** Whether we check that our trainers are alive, i.e. we are the aggregator of a cluster subject to churn */
+    bool watches_heartbeats();
+
+    /** Wait for a packet from the network or our Role, nullptr when it is time to check our trainers instead */
+    simgrid::s4u::ActivityPtr wait_activity();
+
+    /** Look for trainers whose host failed since the last check */
+    void check_heartbeats();
+
+    /** Stop sending packets to a node that failed, and tell our Role not to wait for it */
+    void handle_departure(const protocol::NodeInfo &node);
+
+    /** Register a node that joins while the cluster is running, such as a trainer that recovered from a failure */
+    void handle_join(const protocol::operations::RegistrationRequest &request);
+
+    void send_registration_confirmation(const protocol::NodeInfo &node);
 public:
     StarNetworkManager(protocol::NodeInfo);
     ~StarNetworkManager();
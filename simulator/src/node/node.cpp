@@ -1,5 +1,6 @@
 #include "node.hpp"
 #include "mediator/mediator_producer.hpp"
+#include "../constants.hpp"
 #include "network_managers/nm.hpp"
 #include <format>
 #include <memory>
@@ -24,22 +25,49 @@ Node::Node(Role *r, NetworkManager *nm)
     auto mc = make_unique<MediatorConsumer>(this->get_node_info().name);
     auto mp = make_unique<MediatorProducer>(this->get_node_info().name);
 
+    if (Constants::FUSE_NODE_ACTORS && this->role->can_share_actor())
+    {
+        auto channel = make_shared<Mediator::DirectChannel>();
+        channel->step_network_manager = [nm]() { nm->run(); };
+        channel->watch_activity = [nm](simgrid::s4u::ActivityPtr a) { nm->watch_activity(a); };
+
+        mc->set_direct_channel(channel);
+        mp->set_direct_channel(channel);
+    }
+
     this->role->set_mediator_consumer(std::move(mc));
     this->network_manager->set_mediator_producer(std::move(mp));
 }
 
-void Node::run()
+void Node::run(bool daemonize)
 {
     node_name name = this->get_node_info().name;
     auto e = simgrid::s4u::Engine::get_instance();
 
-    simgrid::s4u::Actor::create(
+    if (Constants::FUSE_NODE_ACTORS && this->role->can_share_actor())
+    {
+        auto actor = simgrid::s4u::Actor::create(
+            std::format("{}_node", name), e->host_by_name(name), &Node::run_fused, this->role, this->network_manager
+        );
+
+        if (daemonize)
+            actor->daemonize();
+        return;
+    }
+
+    auto role_actor = simgrid::s4u::Actor::create(
         std::format("{}_role", name), e->host_by_name(name), &Node::run_role, this->role
     );
 
-    simgrid::s4u::Actor::create(
+    auto nm_actor = simgrid::s4u::Actor::create(
         std::format("{}_nm", name), e->host_by_name(name), &Node::run_network_manager, this->network_manager
     );
+
+    if (daemonize)
+    {
+        role_actor->daemonize();
+        nm_actor->daemonize();
+    }
 }
 
 NodeInfo Node::get_node_info()
@@ -41,8 +41,9 @@ public:
     /**
      * Main function to execute the Node's behaviour.
      * Call the run function of the Role and NetworkManager.
+     * @param daemonize Whether the actors of the Node shouldn't keep the simulation running.
      */
-    void run();
+    void run(bool daemonize=false);
 
     /**
      * Call set_bootstrap_nodes() of the Node's NetworkManager.
@@ -78,6 +79,16 @@ public:
         simgrid::s4u::this_actor::on_exit([nm](bool failed) { delete nm; });
         while (true) { nm->run(); };
     }
+
+    /** 
+     * Run both the Role and the NetworkManager in the same actor. The Role drives the execution and steps the
+     * NetworkManager each time it waits for something, see Mediator::DirectChannel.
+     */
+    static void run_fused(Role *r, NetworkManager *nm)
+    {
+        simgrid::s4u::this_actor::on_exit([r, nm](bool failed) { delete r; delete nm; });
+        while (true) { r->run(); };
+    }
 };
 
 #endif // !FALAFELS_NODE_HPP
@@ -1,32 +1,103 @@
+#include <algorithm>
+#include <cmath>
 #include <simgrid/s4u/Engine.hpp>
 #include <xbt/asserts.h>
 #include <xbt/log.h>
 
 #include "aggregator.hpp"
+#include "end_condition_watcher.hpp"
 #include "../../../constants.hpp"
+#include "../../../profiler.hpp"
+#include "../../../trace_replay.hpp"
 
 XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_aggregator, "Messages specific for this example");
 
 using namespace protocol;
 
+/** Mean and standard deviation of a non empty list of durations */
+static std::pair<double, double> get_mean_stddev(const std::vector<double> &durations)
+{
+    double mean = 0.0, variance = 0.0;
+
+    for (double duration: durations)
+        mean += duration / durations.size();
+
+    for (double duration: durations)
+        variance += (duration - mean) * (duration - mean) / durations.size();
+
+    return { mean, sqrt(variance) };
+}
+
 Aggregator::Aggregator(node_name name)
 {
     this->initialization_time = simgrid::s4u::Engine::get_instance()->get_clock();
     this->my_node_name = name;
     this->aggregating_activities = new simgrid::s4u::ActivitySet();
+    this->convergence = ConvergenceModel::create();
+
+    if (Constants::DVFS_LEARNING_ROUNDS != 0)
+        this->slack_reclaimer = std::make_unique<SlackReclaimer>();
+}
+
+double Aggregator::get_aggregating_flops_per_core(double flops, int nb_core, uint64_t number_local_models)
+{
+    // Number for one aggregation splitted in one core
+    double total_nb_flops_per_core = (flops / nb_core) * number_local_models;
+
+    XBT_DEBUG("(flops / nb_core) * nb_local_models = total_nb_flops_per_core <-> (%f / %i) * %lu = %f", 
+              flops, nb_core, number_local_models, total_nb_flops_per_core);
+
+    return total_nb_flops_per_core;
+}
+
+void Aggregator::record_local_model(const operations::SendLocalModel &local_model)
+{
+    this->number_local_models += local_model.number_local_models;
+    this->total_number_local_epochs += local_model.number_local_epochs_done;
+    this->number_samples += local_model.number_samples;
+
+    this->convergence->add_local_model(local_model, this->global_model_version - local_model.global_model_version,
+                                       this->constants->MODEL_SIZE_BYTES);
+
+    if (this->slack_reclaimer)
+        this->slack_reclaimer->record_local_model(local_model);
+}
+
+void Aggregator::handle_membership_change(const operations::MembershipChange &change)
+{
+    auto &node = change.node;
+
+    if (change.joined)
+    {
+        XBT_INFO("%s joined, it will train from the next round on", node.name.c_str());
+        this->joining_trainers[node.name] = node.multiplicity;
+
+        // Nobody is left to end the current round, the joining trainers receive the global model right away
+        if (this->number_client_training == 0 && this->number_local_models == 0)
+        {
+            XBT_INFO("No trainer left in the current round, restarting it");
+            this->send_global_model();
+        }
+    }
+    else if (this->joining_trainers.erase(node.name) == 0)
+    {
+        this->number_registered_trainers = max(this->number_registered_trainers, (uint64_t) this->number_client_training);
+        this->number_client_training -= min((uint32_t) this->number_client_training, node.multiplicity);
+        XBT_INFO("%s departed, %u trainers left", node.name.c_str(), this->number_client_training);
+    }
 }
 
 void Aggregator::aggregate() 
 {
-    double flops = Constants::GLOBAL_MODEL_AGGREGATING_FLOPS;
+    double start_time = simgrid::s4u::Engine::get_instance()->get_clock();
 
     int nb_core = simgrid::s4u::this_actor::get_host()->get_core_count();
+    double total_nb_flops_per_core = Aggregator::get_aggregating_flops_per_core(
+        this->constants->GLOBAL_MODEL_AGGREGATING_FLOPS, nb_core, this->number_local_models
+    );
 
-    // Number for one aggregation splitted in one core
-    double total_nb_flops_per_core = (flops / nb_core) * this->number_local_models;
-
-    XBT_DEBUG("(flops / nb_core) * nb_local_models = total_nb_flops_per_core <-> (%f / %i) * %u = %f", 
-              flops, nb_core, this->number_local_epochs, total_nb_flops_per_core);
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_compute(total_nb_flops_per_core * nb_core);
     
     // Launch exactly nb_core parallel tasks
     for (int i = 0; i < nb_core; i++)
@@ -35,20 +106,59 @@ void Aggregator::aggregate()
     }
 
     // Wait for the tasks to complete
-    this->aggregating_activities->wait_all();
-    // Increment the number of aggregated models
+    this->mc->wait_activities(this->aggregating_activities);
+
+    double end_time = simgrid::s4u::Engine::get_instance()->get_clock();
+    this->round_durations.push_back(end_time - this->round_start_time);
+
+    auto [mean, stddev] = get_mean_stddev(this->round_durations);
+    XBT_INFO("Round %lu took %f s (so far: mean=%f s stddev=%f s)", this->round_durations.size(), 
+             this->round_durations.back(), mean, stddev);
+
+    this->global_model_version++;
+    this->number_registered_trainers = max(this->number_registered_trainers, (uint64_t) this->number_client_training);
+    this->convergence->aggregate(this->number_registered_trainers);
+    XBT_INFO("Simulated accuracy: %f after %f effective epochs", this->convergence->get_accuracy(), 
+             this->convergence->get_effective_epochs());
+
+    if (PhaseProfiler::get_instance().is_enabled())
+        PhaseProfiler::get_instance().record(this->my_node_name, PhaseProfiler::AGGREGATION, start_time, end_time);
+
+    // Increment the number of aggregated models, and their weight
     this->total_aggregated_models += this->number_local_models;
-    // Compute the number of global epochs
-    this->number_global_epochs = this->total_aggregated_models / this->number_client_training;
+    this->total_number_samples += this->number_samples;
+    // One global epoch per aggregation, whatever the number of trainers that churn left us with
+    this->number_global_epochs++;
 }
 
 void Aggregator::send_global_model()
 {
+    if (this->slack_reclaimer)
+        this->slack_reclaimer->start_round();
+
+    this->round_start_time = simgrid::s4u::Engine::get_instance()->get_clock();
+
+    // Joining trainers will receive this global model
+    for (auto &[name, multiplicity]: this->joining_trainers)
+        this->number_client_training += multiplicity;
+
+    this->joining_trainers.clear();
+
+    if (PhaseProfiler::get_instance().is_enabled())
+    {
+        // The broadcast is extended by the receivers of the global model
+        double now = simgrid::s4u::Engine::get_instance()->get_clock();
+        PhaseProfiler::get_instance().start_round(this->my_node_name);
+        PhaseProfiler::get_instance().record(this->my_node_name, PhaseProfiler::BROADCAST, now, now);
+    }
+
     this->mc->put_async_to_be_sent_packet(
         // Send global model with broadcast because we specify a filter instead of a dst
         filters::trainers,
         operations::SendGlobalModel(
-            this->number_local_epochs
+            this->number_local_epochs,
+            this->constants->MODEL_SIZE_BYTES,
+            this->global_model_version
         )
     );
 }
@@ -66,18 +176,36 @@ void Aggregator::send_kills()
 
 bool Aggregator::check_end_condition()
 {
-    if (Constants::END_CONDITION_DURATION_TRAINING_PHASE != 0.0)
+    if (this->is_end_condition_reached())
+        return true;
+
+    // Stop early if the remaining rounds can be extrapolated
+    return Constants::STEADY_STATE_ROUNDS != 0 && this->check_steady_state();
+}
+
+bool Aggregator::is_end_condition_reached()
+{
+    // Duration and energy budget are also watched by the EndConditionWatcher, in case they run out between aggregations
+    if (this->constants->END_CONDITION_DURATION_TRAINING_PHASE != 0.0)
+    {
+        return simgrid::s4u::Engine::get_instance()->get_clock() 
+               >= this->initialization_time + this->constants->END_CONDITION_DURATION_TRAINING_PHASE;
+    }
+    else if (this->constants->END_CONDITION_NUMBER_ROUNDS != 0)
     {
-        xbt_die("NOT IMPLEMENTED");
-        // return simgrid::s4u::Engine::get_instance()->get_clock() > this->initialization_time + Constants::END_CONDITION_DURATION_TRAINING_PHASE;
+        return this->number_global_epochs >= this->constants->END_CONDITION_NUMBER_ROUNDS;
     }
-    else if (Constants::END_CONDITION_NUMBER_ROUNDS != 0)
+    else if (this->constants->END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS != 0)
     {
-        return this->number_global_epochs >= Constants::END_CONDITION_NUMBER_ROUNDS;
+        return this->total_number_local_epochs >= this->constants->END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS;
     }
-    else if (Constants::END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS != 0)
+    else if (this->constants->END_CONDITION_TARGET_ACCURACY != 0.0)
     {
-        return this->total_number_local_epochs >= Constants::END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS;
+        return this->convergence->get_accuracy() >= this->constants->END_CONDITION_TARGET_ACCURACY;
+    }
+    else if (Constants::END_CONDITION_ENERGY_BUDGET != 0.0)
+    {
+        return SimulationResult::collect().get_total_consumption() >= Constants::END_CONDITION_ENERGY_BUDGET;
     }
     else
     {
@@ -86,13 +214,133 @@ bool Aggregator::check_end_condition()
     }
 }
 
+void Aggregator::watch_end_condition()
+{
+    if (this->is_main_aggregator)
+        EndConditionWatcher::start(this->my_node_name, *this->constants, this->initialization_time);
+}
+
+void Aggregator::handle_end_condition_reached()
+{
+    XBT_INFO("End condition reached with %lu local models of the current round received", this->number_local_models);
+
+    this->print_end_report();
+    this->send_kills();
+}
+
+bool Aggregator::check_steady_state()
+{
+    this->round_snapshots.push_back(RoundSnapshot {
+        .result = SimulationResult::collect(),
+        .total_number_local_epochs = this->total_number_local_epochs,
+    });
+
+    // Comparing K rounds needs K + 1 snapshots
+    const uint64_t nb_rounds = Constants::STEADY_STATE_ROUNDS;
+
+    if (this->round_snapshots.size() > nb_rounds + 1)
+        this->round_snapshots.pop_front();
+
+    if (this->round_snapshots.size() < nb_rounds + 1)
+        return false;
+
+    auto last_delta = this->round_snapshots[nb_rounds].result - this->round_snapshots[nb_rounds - 1].result;
+
+    for (uint64_t i = 1; i < nb_rounds; i++)
+    {
+        auto delta = this->round_snapshots[i].result - this->round_snapshots[i - 1].result;
+
+        if (!delta.agrees_with(last_delta, Constants::STEADY_STATE_TOLERANCE))
+            return false;
+    }
+
+    uint64_t epochs_per_round = 
+        this->round_snapshots[nb_rounds].total_number_local_epochs - this->round_snapshots[nb_rounds - 1].total_number_local_epochs;
+
+    // Number of rounds needed to reach the end condition, which isn't reached yet
+    uint64_t remaining_rounds;
+
+    if (this->constants->END_CONDITION_NUMBER_ROUNDS != 0)
+    {
+        remaining_rounds = this->constants->END_CONDITION_NUMBER_ROUNDS - this->number_global_epochs;
+    }
+    else if (this->constants->END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS != 0 && epochs_per_round > 0)
+    {
+        uint64_t remaining_epochs = this->constants->END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS - this->total_number_local_epochs;
+        remaining_rounds = (remaining_epochs + epochs_per_round - 1) / epochs_per_round;
+    }
+    else if (this->constants->END_CONDITION_TARGET_ACCURACY != 0.0 && this->convergence->get_last_effective_epochs() > 0.0)
+    {
+        remaining_rounds = this->convergence->get_remaining_aggregations(this->constants->END_CONDITION_TARGET_ACCURACY);
+    }
+    // Only the rounds that fully fit in the remaining duration or energy are extrapolated
+    else if (this->constants->END_CONDITION_DURATION_TRAINING_PHASE != 0.0 && last_delta.simulation_time > 0.0)
+    {
+        double remaining_time = this->initialization_time + this->constants->END_CONDITION_DURATION_TRAINING_PHASE 
+                                - this->round_snapshots[nb_rounds].result.simulation_time;
+        remaining_rounds = floor(remaining_time / last_delta.simulation_time);
+    }
+    else if (Constants::END_CONDITION_ENERGY_BUDGET != 0.0 && last_delta.get_total_consumption() > 0.0)
+    {
+        double remaining_energy = Constants::END_CONDITION_ENERGY_BUDGET 
+                                  - this->round_snapshots[nb_rounds].result.get_total_consumption();
+        remaining_rounds = floor(remaining_energy / last_delta.get_total_consumption());
+    }
+    else
+    {
+        return false;
+    }
+
+    XBT_INFO("Steady state reached after %lu rounds, extrapolating the %lu remaining rounds", 
+             this->number_global_epochs, remaining_rounds);
+
+    SimulationResult::set_extrapolation(this->my_node_name, remaining_rounds, last_delta);
+
+    // Update counters as if the remaining rounds were simulated
+    this->number_extrapolated_rounds = remaining_rounds;
+    this->total_number_local_epochs += remaining_rounds * epochs_per_round;
+    this->total_aggregated_models += remaining_rounds * this->number_local_models;
+    this->total_number_samples += remaining_rounds * this->number_samples;
+    this->number_global_epochs += remaining_rounds;
+    this->global_model_version += remaining_rounds;
+    this->convergence->extrapolate(remaining_rounds);
+
+    return true;
+}
+
 void Aggregator::print_end_report()
 {
     XBT_INFO("---------------------------- End Report----------------------------------");
     XBT_INFO("Total number of local epochs: %lu", this->total_number_local_epochs);
     XBT_INFO("Number of model aggregated: %lu", this->total_aggregated_models);
+    XBT_INFO("Number of samples the aggregated models were trained on: %lu", this->total_number_samples);
     XBT_INFO("Number of client that were training: %u", this->number_client_training);
-    XBT_INFO("Number of global epochs done: %u", this->number_global_epochs);
+    XBT_INFO("Number of global epochs done: %lu", this->number_global_epochs);
+    XBT_INFO("Simulated accuracy: %f after %f effective epochs", this->convergence->get_accuracy(), 
+             this->convergence->get_effective_epochs());
+
+    if (this->number_extrapolated_rounds != 0)
+        XBT_INFO("Including %lu extrapolated rounds", this->number_extrapolated_rounds);
+
+    if (!this->round_durations.empty())
+    {
+        // Only simulated rounds, the first one including the registration
+        double number_rounds = this->round_durations.size();
+        auto [mean, stddev] = get_mean_stddev(this->round_durations);
+        auto [min, max] = std::minmax_element(this->round_durations.begin(), this->round_durations.end());
+
+        XBT_INFO("Round time: mean=%f s stddev=%f s min=%f s max=%f s", mean, stddev, *min, *max);
+
+        double elapsed = simgrid::s4u::Engine::get_instance()->get_clock() - this->initialization_time;
+
+        if (elapsed > 0.0)
+            XBT_INFO("Throughput: %f local models/s, %f aggregations/s", 
+                     (this->total_aggregated_models - this->number_extrapolated_rounds * this->number_local_models) / elapsed,
+                     number_rounds / elapsed);
+    }
+
+    if (this->slack_reclaimer)
+        this->slack_reclaimer->print_report();
     XBT_INFO("-------------------------------------------------------------------------");
 }
 
@@ -3,7 +3,13 @@
 #define FALAFELS_AGGREGATOR_HPP
 
 #include "../role.hpp"
+#include "slack_reclaimer.hpp"
+#include "../../../convergence.hpp"
+#include "../../../result.hpp"
 #include <cstdint>
+#include <deque>
+#include <unordered_map>
+#include <vector>
 #include <simgrid/forward.h>
 #include <simgrid/s4u/Exec.hpp>
 #include <simgrid/s4u/ActivitySet.hpp>
@@ -15,7 +21,7 @@ protected:
     uint8_t number_local_epochs = 3;
 
     /** Value indicating the number of global epochs achieved by the aggregator */
-    uint16_t number_global_epochs = 0;
+    uint64_t number_global_epochs = 0;
 
     /** Number of local model aggregated, used to compute the global number of epochs. */
     uint64_t total_aggregated_models = 0;
@@ -23,11 +29,23 @@ protected:
     /** The actual number of trainers */
     uint16_t number_client_training = 65535; // Set it to max value until we get the actual one
 
+    /** 
+     * Largest number of trainers that trained at once, which participation is computed against so that trainers
+     * departed because of churn still count as missing.
+     */
+    uint64_t number_registered_trainers = 0;
+
     /** Number of the local models collected at a moment in time */
     uint64_t number_local_models = 0;    
 
     uint64_t total_number_local_epochs = 0;
 
+    /** Number of samples the local models collected at a moment in time were trained on, i.e. their total weight */
+    uint64_t number_samples = 0;
+
+    /** Total weight of the local models aggregated so far */
+    uint64_t total_number_samples = 0;
+
     /** Simgrid activity representing the training */
     simgrid::s4u::ActivitySet *aggregating_activities;
 
@@ -36,6 +54,58 @@ protected:
 
     bool is_main_aggregator = false;
 
+    /** State of the simulation after an aggregation, used to detect the steady state */
+    struct RoundSnapshot
+    {
+        SimulationResult result;
+        uint64_t total_number_local_epochs;
+    };
+
+    /** Trainers that joined the cluster during the current round, they only train from the next global model on */
+    std::unordered_map<protocol::node_name, uint32_t> joining_trainers;
+
+    /** 
+     * Stop waiting for the trainers that departed, and count the ones that joined from the next round on. When every
+     * trainer departed without sending anything, the round is restarted right away for the joining trainers.
+     */
+    void handle_membership_change(const protocol::operations::MembershipChange &change);
+
+    /** 
+     * Whether the given proportion of the trainers sent their local model for the current round. When every trainer 
+     * departed, the local models they sent before end the round as soon as trainers joined to train on the next one.
+     */
+    bool received_all_local_models(double proportion = 1.0) 
+    {
+        if (this->number_client_training == 0)
+            return this->number_local_models != 0 && !this->joining_trainers.empty();
+
+        return this->number_local_models >= this->number_client_training * proportion;
+    }
+
+    /** Account for a received local model, weighted by its number of samples */
+    void record_local_model(const protocol::operations::SendLocalModel &local_model);
+
+    /** Snapshots of the last STEADY_STATE_ROUNDS + 1 rounds */
+    std::deque<RoundSnapshot> round_snapshots;
+
+    /** Set when DVFS_LEARNING_ROUNDS is defined */
+    std::unique_ptr<SlackReclaimer> slack_reclaimer;
+
+    /** Time at which the global model of the current round was sent */
+    double round_start_time = 0.0;
+
+    /** Duration of each simulated round, from the sending of its global model to the end of its aggregation */
+    std::vector<double> round_durations;
+
+    /** Number of aggregations done, sent along global models to measure the staleness of local models */
+    uint64_t global_model_version = 0;
+
+    /** Simulated accuracy of our global model */
+    std::unique_ptr<ConvergenceModel> convergence;
+
+    /** Number of rounds that were extrapolated instead of simulated */
+    uint64_t number_extrapolated_rounds = 0;
+
     /**
      * Run and wait all aggregations steps in parallel, sharing activities among the Host's cores.
      * Groups all tasks into a big one, which is way more efficient (in terms of simulation runtime) 
@@ -59,13 +129,36 @@ protected:
     void print_end_report();
 
     /**
-     * Checks if the training phase should stop
+     * Checks if the training phase should stop, either because the end condition is reached or because the remaining
+     * rounds can be extrapolated.
      */
     bool check_end_condition();
+
+    /** Checks if the configured end condition is reached */
+    bool is_end_condition_reached();
+
+    /** 
+     * As main aggregator, start the EndConditionWatcher of a duration or energy budget end condition. Called once the
+     * cluster is connected, so that its NetworkManager routes the EndConditionReached to us.
+     */
+    void watch_end_condition();
+
+    /** End the training when told by the EndConditionWatcher, even if some local models didn't arrive yet */
+    void handle_end_condition_reached();
+
+    /**
+     * Checks if the last STEADY_STATE_ROUNDS rounds had the same duration and energy deltas. In that case, the 
+     * remaining rounds until the end condition are registered to be extrapolated and our counters are updated as if 
+     * they were simulated.
+     */
+    bool check_steady_state();
 public:
     Aggregator(protocol::node_name name);
     virtual ~Aggregator() { delete this->aggregating_activities; } 
 
+    /** Number of flops each core of a host with nb_core cores computes to aggregate number_local_models models of the given cost */
+    static double get_aggregating_flops_per_core(double flops, int nb_core, uint64_t number_local_models);
+
     protocol::NodeRole get_role_type()
     {
         return this->is_main_aggregator ? protocol::NodeRole::MainAggregator : protocol::NodeRole::Aggregator; 
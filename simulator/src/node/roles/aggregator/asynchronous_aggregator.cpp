@@ -65,6 +65,7 @@ void AsynchronousAggregator::run()
                 if (auto *conneted_event = get_if<Mediator::ClusterConnected>(e.get()))
                 {
                     this->number_client_training = conneted_event->number_client_connected;
+                    this->watch_end_condition();
                     this->state = WAITING_LOCAL_MODELS;
                 }
                 break;
@@ -76,14 +77,23 @@ void AsynchronousAggregator::run()
                 // If the operation is a SendLocalModel
                 if (auto *op_send_local = get_if<operations::SendLocalModel>(op.get()))
                 {
-                    this->number_local_models += 1;
-                    this->total_number_local_epochs += op_send_local->number_local_epochs_done;
+                    this->record_local_model(*op_send_local);
+                }
+                else if (auto *change = get_if<operations::MembershipChange>(op.get()))
+                {
+                    this->handle_membership_change(*change);
+                }
+                // The training duration or the energy budget ran out before every local model arrived
+                else if (get_if<operations::EndConditionReached>(op.get()))
+                {
+                    this->handle_end_condition_reached();
+                    break;
+                }
 
-                    if (this->number_local_models >= this->number_client_training * this->proportion_threshold)
-                    {
-                        XBT_INFO("Received %lu local models, starting aggregation", this->number_local_models);
-                        this->state = AGGREGATING;
-                    }
+                if (this->received_all_local_models(this->proportion_threshold))
+                {
+                    XBT_INFO("Received %lu local models, starting aggregation", this->number_local_models);
+                    this->state = AGGREGATING;
                 }
                 break;
             }
@@ -103,6 +113,7 @@ void AsynchronousAggregator::run()
                 {
                     this->send_global_model();
                     this->number_local_models = 0;
+                    this->number_samples = 0;
                     this->state = WAITING_LOCAL_MODELS;
                 }
                 break;
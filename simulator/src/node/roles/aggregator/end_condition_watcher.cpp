@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <format>
+#include <simgrid/s4u/Actor.hpp>
+#include <simgrid/s4u/Disk.hpp>
+#include <simgrid/s4u/Engine.hpp>
+#include <simgrid/s4u/Host.hpp>
+#include <simgrid/s4u/Link.hpp>
+#include <simgrid/s4u/Mailbox.hpp>
+#include <xbt/asserts.h>
+#include <xbt/log.h>
+
+#include "end_condition_watcher.hpp"
+#include "../../../result.hpp"
+#include "../../../symmetry.hpp"
+#include "../../../trace_replay.hpp"
+#include "../../../utils/utils.hpp"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_end_condition_watcher, "Messages specific for this example");
+
+using namespace std;
+using namespace protocol;
+
+/** Relative part of the energy budget left when it is considered exhausted, the power estimates being approximate */
+static const double ENERGY_BUDGET_TOLERANCE = 1e-6;
+
+void EndConditionWatcher::start(node_name aggregator_name, const ClusterConstants &constants, double initialization_time)
+{
+    double deadline = 0.0;
+
+    // Same precedence as Aggregator::is_end_condition_reached()
+    bool other_end_condition = constants.END_CONDITION_NUMBER_ROUNDS != 0
+                               || constants.END_CONDITION_TOTAL_NUMBER_LOCAL_EPOCHS != 0
+                               || constants.END_CONDITION_TARGET_ACCURACY != 0.0;
+
+    if (constants.END_CONDITION_DURATION_TRAINING_PHASE != 0.0)
+        deadline = initialization_time + constants.END_CONDITION_DURATION_TRAINING_PHASE;
+    else if (other_end_condition || Constants::END_CONDITION_ENERGY_BUDGET == 0.0)
+        return;
+
+    auto e = simgrid::s4u::Engine::get_instance();
+
+    simgrid::s4u::Actor::create(
+        std::format("{}_end_condition", aggregator_name), e->host_by_name(aggregator_name),
+        EndConditionWatcher(aggregator_name, deadline, Constants::END_CONDITION_ENERGY_BUDGET)
+    )->daemonize();
+}
+
+EndConditionWatcher::EndConditionWatcher(node_name aggregator_name, double deadline, double energy_budget)
+{
+    this->aggregator_name = aggregator_name;
+    this->deadline = deadline;
+    this->energy_budget = energy_budget;
+}
+
+void EndConditionWatcher::operator()()
+{
+    if (this->deadline != 0.0)
+        this->wait_deadline();
+    else
+        this->wait_energy_budget();
+
+    this->notify();
+}
+
+void EndConditionWatcher::wait_deadline()
+{
+    double duration = this->deadline - simgrid::s4u::Engine::get_instance()->get_clock();
+
+    if (duration <= 0.0)
+        return;
+
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_sleep(duration);
+
+    simgrid::s4u::this_actor::sleep_for(duration);
+    XBT_INFO("Training phase reached its deadline at %f s", this->deadline);
+}
+
+/** 
+ * Upper bound of the power the platform can draw: hosts on every core at their most consuming pstate, as trainers may
+ * wake up or be given another pstate, and links and disks busy. Shadows draw as much as their representative.
+ */
+static double get_max_platform_power()
+{
+    auto e = simgrid::s4u::Engine::get_instance();
+    double power = 0.0;
+
+    for (auto host: e->get_all_hosts())
+    {
+        auto representative = SymmetryReduction::get_instance().get_representative(host->get_name());
+        auto measured = representative.has_value() ? e->host_by_name(*representative) : host;
+        double max_wattage = 0.0;
+
+        // Idle, one core and all cores wattages of each pstate
+        for (unsigned long pstate = 0; pstate < measured->get_pstate_count(); pstate++)
+        {
+            auto wattages = parse_wattages(measured->get_property("wattage_per_state"), pstate);
+            if (!wattages.empty())
+                max_wattage = max(max_wattage, wattages.back());
+        }
+
+        power += max_wattage;
+
+        // Properties of SimGrid's disk energy plugin
+        for (auto disk: host->get_disks())
+        {
+            double disk_wattage = 0.0;
+
+            for (auto property: { "wattage_idle", "wattage_read", "wattage_write" })
+            {
+                if (auto wattage = disk->get_property(property))
+                    disk_wattage = max(disk_wattage, stod(wattage));
+            }
+
+            power += disk_wattage;
+        }
+    }
+
+    for (auto link: e->get_all_links())
+    {
+        // Idle and busy wattages
+        auto wattages = parse_wattages(link->get_property("wattage_range"), 0);
+        if (!wattages.empty())
+            power += wattages.back();
+    }
+
+    return power;
+}
+
+void EndConditionWatcher::wait_energy_budget()
+{
+    double max_power = get_max_platform_power();
+
+    xbt_assert(max_power > 0.0, "Energy budget %f J can never be exhausted, the platform doesn't consume any energy",
+               this->energy_budget);
+
+    while (true)
+    {
+        double remaining = this->energy_budget - SimulationResult::collect().get_total_consumption();
+
+        if (remaining <= this->energy_budget * ENERGY_BUDGET_TOLERANCE)
+            break;
+
+        // The platform can't consume the remaining energy any sooner, so the budget is never overshot
+        if (TraceRecorder::get_instance().is_enabled())
+            TraceRecorder::get_instance().record_sleep(remaining / max_power);
+
+        simgrid::s4u::this_actor::sleep_for(remaining / max_power);
+    }
+
+    XBT_INFO("Energy budget of %f J exhausted", this->energy_budget);
+}
+
+void EndConditionWatcher::notify()
+{
+    auto p = new Packet(filters::aggregators, operations::EndConditionReached {});
+    p->src = this->aggregator_name;
+    p->dst = this->aggregator_name;
+    p->original_src = this->aggregator_name;
+    p->send_time = simgrid::s4u::Engine::get_instance()->get_clock();
+    p->hop_send_time = p->send_time;
+
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_send(*p);
+
+    // Received by the NetworkManager as any packet, which puts the operation for the aggregator
+    simgrid::s4u::Mailbox::by_name(this->aggregator_name)->put(p, p->get_packet_size());
+}
@@ -0,0 +1,40 @@
+/* EndConditionWatcher */
+#ifndef FALAFELS_END_CONDITION_WATCHER_HPP
+#define FALAFELS_END_CONDITION_WATCHER_HPP
+
+#include "../../../constants.hpp"
+#include "../../../protocol.hpp"
+
+/**
+ * Daemon actor running on the host of the main aggregator, telling it when END_CONDITION_DURATION_TRAINING_PHASE or
+ * END_CONDITION_ENERGY_BUDGET is exhausted with an EndConditionReached sent to its own Node. The aggregator then ends
+ * the training even if it is waiting for local models, instead of only checking its end condition after aggregations.
+ *
+ * The clock is never polled: it sleeps until the deadline, or until the budget would be exhausted at the maximum power
+ * of the platform, and sleeps again on the energy that remains when waking up.
+ */
+class EndConditionWatcher
+{
+public:
+    /** Start watching the end condition of the given constants, if it is a duration or an energy budget */
+    static void start(protocol::node_name aggregator_name, const ClusterConstants &constants, double initialization_time);
+
+    void operator()();
+private:
+    EndConditionWatcher(protocol::node_name aggregator_name, double deadline, double energy_budget);
+
+    protocol::node_name aggregator_name;
+
+    /** Time at which the training phase ends, 0.0 when watching the energy budget */
+    double deadline;
+
+    double energy_budget;
+
+    void wait_deadline();
+    void wait_energy_budget();
+
+    /** Send the EndConditionReached to the NetworkManager of the aggregator */
+    void notify();
+};
+
+#endif // !FALAFELS_END_CONDITION_WATCHER_HPP
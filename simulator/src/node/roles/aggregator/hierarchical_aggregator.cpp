@@ -5,6 +5,7 @@
 #include "hierarchical_aggregator.hpp"
 #include "../../network_managers/hierarchical_nm.hpp"
 #include "../../../utils/utils.hpp"
+#include "../../../dot.hpp"
 #include "../../node.hpp"
 
 
@@ -19,10 +20,12 @@ HierarchicalAggregator::HierarchicalAggregator(std::unordered_map<std::string, s
     {
         switch (str2int(key.c_str()))
         {
+            // central_aggregator_name is kept for the two levels deployments generated so far
             case str2int("central_aggregator_name"):
+            case str2int("parent_aggregator_name"):
                 {
-                    XBT_INFO("central_aggregator_name=%s", value.c_str());
-                    this->central_aggregator_name = value;
+                    XBT_INFO("parent_aggregator_name=%s", value.c_str());
+                    this->parent_aggregator_name = value;
                     break;
                 }
             case str2int("is_main_aggregator"):
@@ -42,39 +45,40 @@ HierarchicalAggregator::HierarchicalAggregator(std::unordered_map<std::string, s
         }
     } 
 
-    this->setup_central_nm();
+    this->setup_parent_link();
 
     delete args;
 }
 
-void HierarchicalAggregator::setup_central_nm()
+void HierarchicalAggregator::setup_parent_link()
 {
-    // Create a new node name to be used for the mailbox that will be receiving and sending to the central aggregator
-    auto new_node_name = format("hierarchical_{}", this->my_node_name);
+    // The parent link needs its own mailbox to be distinguished from the NetworkManager of our cluster
+    auto parent_link_name = format("{}_parent_link", this->my_node_name);
 
-    // Pretend we are a trainer to be able to register to the central aggregator
-    auto my_node_info = NodeInfo { .name = new_node_name, .role = NodeRole::Trainer};
+    // Pretend we are a trainer to be able to register to the parent aggregator
+    auto parent_link_info = NodeInfo { .name = parent_link_name, .role = NodeRole::Trainer };
         
-    auto central_nm = new HierarchicalNetworkManager(my_node_info);
+    auto parent_link = new HierarchicalNetworkManager(parent_link_info);
+    parent_link->set_parent_link_owner(this->my_node_name);
 
-    // Set the central_aggregator_name as bootstrap node so we can register to it when the hierarchical_aggregator is run.
-    central_nm->set_bootstrap_nodes(
+    // Set the parent_aggregator_name as bootstrap node so we can register to it when the hierarchical_aggregator is run.
+    parent_link->set_bootstrap_nodes(
         new vector<NodeInfo>({ 
-            NodeInfo { .name=this->central_aggregator_name, .role=NodeRole::MainAggregator } 
+            NodeInfo { .name=this->parent_aggregator_name, .role=NodeRole::MainAggregator } 
         })
     );
 
-    auto central_mc = make_unique<MediatorConsumer>(new_node_name);
-    auto central_mp = make_unique<MediatorProducer>(new_node_name);
+    this->parent_mc = make_unique<MediatorConsumer>(parent_link_name);
+    parent_link->set_mediator_producer(make_unique<MediatorProducer>(parent_link_name));
 
-    this->central_mc = std::move(central_mc);
-
-    central_nm->set_mediator_producer(std::move(central_mp));
+    // On graphs, the parent link and the cluster NetworkManager represent the same node
+    if (Constants::GENERATE_DOT_FILES)
+        DOTGenerator::get_instance().add_alias(parent_link_name, this->my_node_name);
 
     auto e = simgrid::s4u::Engine::get_instance();
 
     simgrid::s4u::Actor::create(
-        std::format("{}_nm_hierarchical", this->my_node_name), e->host_by_name(this->my_node_name), &Node::run_network_manager, central_nm 
+        std::format("{}_nm_parent_link", this->my_node_name), e->host_by_name(this->my_node_name), &Node::run_network_manager, parent_link 
     );
 }
 
@@ -82,10 +86,10 @@ void HierarchicalAggregator::run()
 {
     switch (this->state)
     {
-        case INITIALIZING_CENTRAL:
+        case INITIALIZING_PARENT:
             {
-                // Waiting connection on the central aggregator 
-                auto e = this->central_mc->get_nm_event();
+                // Waiting connection on the parent aggregator 
+                auto e = this->parent_mc->get_nm_event();
 
                 // If type of event is ClusterConnected it means that every node have been connected to us
                 if (auto *conneted_event = get_if<Mediator::NodeConnected>(e.get()))
@@ -102,12 +106,13 @@ void HierarchicalAggregator::run()
                 // it first before in order to receive the ClusterConnected event
                 if (this->first_global_model)
                 {
-                    // Waiting global model from the central aggregator
-                    auto op = this->central_mc->get_received_operation();
+                    // Waiting global model from the parent aggregator
+                    auto op = this->parent_mc->get_received_operation();
 
                     // If the operation is a SendGlobalModel
                     if (auto *op_glob = get_if<operations::SendGlobalModel>(op.get()))
                     {
+                        this->parent_global_model_version = op_glob->version;
                         this->send_global_model();
                     }
 
@@ -128,12 +133,13 @@ void HierarchicalAggregator::run()
             }
         case WAITING_GLOBAL_MODEL:
             {
-                // Waiting global model from the central aggregator
-                auto op = this->central_mc->get_received_operation();
+                // Waiting global model from the parent aggregator
+                auto op = this->parent_mc->get_received_operation();
 
                 // If the operation is a SendGlobalModel
                 if (auto *op_glob = get_if<operations::SendGlobalModel>(op.get()))
                 {
+                    this->parent_global_model_version = op_glob->version;
                     this->send_global_model();
                     this->state = WAITING_LOCAL_MODELS;
                 }
@@ -147,16 +153,19 @@ void HierarchicalAggregator::run()
                 // If the packet's operation is a SendLocalModel
                 if (auto *send_local = get_if<operations::SendLocalModel>(op.get()))
                 {
-                    this->number_local_models += 1;
-                    this->total_number_local_epochs += send_local->number_local_epochs_done;
+                    this->record_local_model(*send_local);
                     this->current_number_local_epochs_cluster += send_local->number_local_epochs_done;
 
                     XBT_INFO("nb local models: %lu", this->number_local_models);
+                }
+                else if (auto *change = get_if<operations::MembershipChange>(op.get()))
+                {
+                    this->handle_membership_change(*change);
+                }
 
-                    if (this->number_local_models >= this->number_client_training)
-                    {
-                        this->state = AGGREGATING;
-                    }
+                if (this->received_all_local_models())
+                {
+                    this->state = AGGREGATING;
                 }
                 break;
             }
@@ -165,10 +174,14 @@ void HierarchicalAggregator::run()
                 // If the aggregating activity has finished (start it if not launched)
                 this->aggregate();
 
-                this->send_model_to_central_aggregator();
+                if (this->slack_reclaimer)
+                    this->slack_reclaimer->end_round();
+
+                this->send_model_to_parent();
 
                 // Reset numbers
                 this->number_local_models = 0;
+                this->number_samples = 0;
                 this->current_number_local_epochs_cluster = 0;
                 this->state = WAITING_GLOBAL_MODEL;
             }
@@ -176,11 +189,19 @@ void HierarchicalAggregator::run()
     }
 }
 
-void HierarchicalAggregator::send_model_to_central_aggregator()
+void HierarchicalAggregator::send_model_to_parent()
 {
-    // Send as if it was a local model (which is the case in theory?).
-    this->central_mc->put_async_to_be_sent_packet(
+    // Send as if it was a local model: the partial aggregate of our subtree.
+    this->parent_mc->put_async_to_be_sent_packet(
         filters::aggregators,
-        operations::SendLocalModel(this->current_number_local_epochs_cluster)
+        operations::SendLocalModel {
+            .number_local_epochs_done = (uint32_t)this->current_number_local_epochs_cluster,
+            .model_size_bytes = this->constants->MODEL_SIZE_BYTES,
+            // The partial aggregate weighs as much as the local models of the subtree
+            .number_samples = this->number_samples,
+            .reference_dataset_size = this->constants->REFERENCE_DATASET_SIZE,
+            .global_model_version = this->parent_global_model_version,
+            .effective_epochs = this->convergence->get_last_effective_epochs(),
+        }
     );
 }
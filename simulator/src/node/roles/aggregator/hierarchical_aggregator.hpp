@@ -6,14 +6,19 @@
 #include <memory>
 
 #include "aggregator.hpp"
-#include "../../network_managers/star_nm.hpp"
 
+/**
+ * Aggregator acting as an inner node of an aggregation tree.
+ * It aggregates the models of its own cluster (its children), sends the partial aggregate to its parent through a
+ * parent link, then waits for the global model of its parent before distributing it to its cluster.
+ * Because the parent of a HierarchicalAggregator can itself be a HierarchicalAggregator, trees of any depth can be built.
+ */
 class HierarchicalAggregator : public Aggregator 
 {
 private:
     using State = enum
     {
-        INITIALIZING_CENTRAL,
+        INITIALIZING_PARENT,
         INITIALIZING_CLUSTER,
         WAITING_GLOBAL_MODEL,
         WAITING_LOCAL_MODELS,
@@ -21,24 +26,34 @@ private:
     };
 
     /** State of the Aggregator */
-    State state = INITIALIZING_CENTRAL;
+    State state = INITIALIZING_PARENT;
 
-    std::unique_ptr<MediatorConsumer> central_mc;
+    /** MediatorConsumer connected to the parent link */
+    std::unique_ptr<MediatorConsumer> parent_mc;
 
-    protocol::node_name central_aggregator_name;
+    /** Name of the aggregator one level above us in the tree */
+    protocol::node_name parent_aggregator_name;
 
     /** Current number of local epochs performed by our cluster */
-    uint64_t current_number_local_epochs_cluster;
+    uint64_t current_number_local_epochs_cluster = 0;
 
     bool first_global_model = true;
 
-    void send_model_to_central_aggregator();
+    /** Version of the last global model of the parent aggregator, see ConvergenceModel */
+    uint64_t parent_global_model_version = 0;
 
-    void setup_central_nm();  
+    /** Send our partial aggregate to the parent aggregator */
+    void send_model_to_parent();
+
+    /** Create and launch the NetworkManager connecting us to our parent aggregator */
+    void setup_parent_link();  
 public:
     HierarchicalAggregator(std::unordered_map<std::string, std::string> *args, protocol::node_name name);
     ~HierarchicalAggregator() {};
     void run() override;
+
+    /** We also block on our parent link, which wouldn't be stepped by a shared actor */
+    bool can_share_actor() override { return false; }
 };
 
 #endif // !FALAFELS_HIERARCHICAL_AGGREGATOR_HPP
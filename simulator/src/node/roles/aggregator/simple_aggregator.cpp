@@ -64,6 +64,7 @@ void SimpleAggregator::run()
                 if (auto *conneted_event = get_if<Mediator::ClusterConnected>(e.get()))
                 {
                     this->number_client_training = conneted_event->number_client_connected;
+                    this->watch_end_condition();
                     this->state = WAITING_LOCAL_MODELS;
                 }
                 break;
@@ -75,14 +76,23 @@ void SimpleAggregator::run()
                 // If the packet's operation is a SendLocalModel
                 if (auto *op_send_local = get_if<operations::SendLocalModel>(op.get()))
                 {
-                    this->number_local_models += 1;
-                    this->total_number_local_epochs += op_send_local->number_local_epochs_done;
+                    this->record_local_model(*op_send_local);
                     XBT_INFO("nb local models: %lu", this->number_local_models);
+                }
+                else if (auto *change = get_if<operations::MembershipChange>(op.get()))
+                {
+                    this->handle_membership_change(*change);
+                }
+                // The training duration or the energy budget ran out before every local model arrived
+                else if (get_if<operations::EndConditionReached>(op.get()))
+                {
+                    this->handle_end_condition_reached();
+                    break;
+                }
 
-                    if (this->number_local_models >= this->number_client_training)
-                    {
-                        this->state = AGGREGATING;
-                    }
+                if (this->received_all_local_models())
+                {
+                    this->state = AGGREGATING;
                 }
                 break;
             }
@@ -90,6 +100,9 @@ void SimpleAggregator::run()
             {
                 this->aggregate();
 
+                if (this->slack_reclaimer)
+                    this->slack_reclaimer->end_round();
+
                 // Only check end condition as MainAggregator
                 if (this->get_role_type() == NodeRole::MainAggregator 
                     && this->check_end_condition())
@@ -102,6 +115,7 @@ void SimpleAggregator::run()
                 {
                     this->send_global_model();
                     this->number_local_models = 0;
+                    this->number_samples = 0;
                     this->state = WAITING_LOCAL_MODELS;
                 }
                 break;
@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <limits>
+#include <simgrid/plugins/energy.h>
+#include <simgrid/s4u/Engine.hpp>
+#include <simgrid/s4u/Host.hpp>
+#include <xbt/log.h>
+
+#include "slack_reclaimer.hpp"
+#include "../../../constants.hpp"
+#include "../../../utils/utils.hpp"
+#include "../trainer/trainer.hpp"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_slack_reclaimer, "Messages specific for this example");
+
+using namespace std;
+using namespace protocol;
+
+void SlackReclaimer::start_round()
+{
+    this->round_start_time = simgrid::s4u::Engine::get_instance()->get_clock();
+}
+
+void SlackReclaimer::record_local_model(const operations::SendLocalModel &local_model)
+{
+    // Partial aggregates of subtrees aren't sent by trainers
+    if (local_model.trainer_name.empty())
+        return;
+
+    this->arrival_times[local_model.trainer_name] = simgrid::s4u::Engine::get_instance()->get_clock();
+
+    if (!this->pstates_assigned)
+    {
+        auto &training_time = this->training_times[local_model.trainer_name];
+        training_time = max(training_time, local_model.training_time);
+    }
+}
+
+void SlackReclaimer::end_round()
+{
+    auto e = simgrid::s4u::Engine::get_instance();
+
+    double duration = e->get_clock() - this->round_start_time;
+
+    double trainers_energy = 0.0;
+    for (auto &[trainer, _]: this->arrival_times)
+        trainers_energy += sg_host_get_consumed_energy(e->host_by_name(trainer));
+
+    double energy = trainers_energy - this->last_trainers_energy;
+    this->last_trainers_energy = trainers_energy;
+
+    this->number_rounds += 1;
+
+    // The first round includes the registration of the trainers
+    if (this->number_rounds > 1)
+    {
+        auto &stats = this->pstates_assigned ? this->after : this->before;
+        stats.number_rounds += 1;
+        stats.total_duration += duration;
+        stats.total_energy += energy;
+    }
+
+    if (this->number_rounds > 1 && !this->pstates_assigned)
+    {
+        double last_arrival = 0.0;
+        for (auto &[_, arrival]: this->arrival_times)
+            last_arrival = max(last_arrival, arrival);
+
+        for (auto &[trainer, arrival]: this->arrival_times)
+        {
+            auto slack = this->slacks.try_emplace(trainer, numeric_limits<double>::infinity()).first;
+            slack->second = min(slack->second, last_arrival - arrival);
+        }
+
+        if (this->before.number_rounds >= Constants::DVFS_LEARNING_ROUNDS)
+            this->assign_pstates();
+    }
+
+    this->arrival_times.clear();
+}
+
+void SlackReclaimer::assign_pstates()
+{
+    auto e = simgrid::s4u::Engine::get_instance();
+
+    for (auto &[trainer, slack]: this->slacks)
+    {
+        auto host = e->host_by_name(trainer);
+        // Trainers may be asleep, their training time was measured at the pstate they have while awake
+        unsigned long current_pstate = Trainer::get_awake_pstate(host);
+
+        // Training may take up to this long without delaying the round
+        double training_time = this->training_times[trainer];
+        double allowed_time = training_time + slack;
+
+        unsigned long best_pstate = current_pstate;
+        double best_energy = numeric_limits<double>::infinity();
+
+        for (unsigned long pstate = 0; pstate < host->get_pstate_count(); pstate++)
+        {
+            double time = training_time * host->get_pstate_speed(current_pstate) / host->get_pstate_speed(pstate);
+
+            if (time > allowed_time)
+                continue;
+
+            // Idle, one core and all cores wattages. Training always uses every core.
+            auto wattages = parse_wattages(host->get_property("wattage_per_state"), pstate);
+            if (wattages.empty())
+                continue;
+
+            double energy = wattages.back() * time + wattages.front() * (allowed_time - time);
+
+            if (energy < best_energy)
+            {
+                best_energy = energy;
+                best_pstate = pstate;
+            }
+        }
+
+        if (best_pstate != current_pstate)
+        {
+            XBT_INFO("Setting pstate %lu on %s, %f s of slack", best_pstate, trainer.c_str(), slack);
+            Trainer::set_awake_pstate(host, best_pstate);
+        }
+    }
+
+    this->pstates_assigned = true;
+}
+
+void SlackReclaimer::print_report()
+{
+    if (this->before.number_rounds == 0 || this->after.number_rounds == 0)
+    {
+        XBT_INFO("DVFS: not enough rounds to compare");
+        return;
+    }
+
+    double duration_before = this->before.total_duration / this->before.number_rounds;
+    double duration_after = this->after.total_duration / this->after.number_rounds;
+    double energy_before = this->before.total_energy / this->before.number_rounds;
+    double energy_after = this->after.total_energy / this->after.number_rounds;
+
+    XBT_INFO("DVFS: mean round time %f s -> %f s (%+f s)", duration_before, duration_after, duration_after - duration_before);
+    XBT_INFO("DVFS: mean trainers energy per round %f J -> %f J (%f J saved)", energy_before, energy_after, energy_before - energy_after);
+}
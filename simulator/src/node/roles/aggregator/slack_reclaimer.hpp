@@ -0,0 +1,60 @@
+/* SlackReclaimer */
+#ifndef FALAFELS_SLACK_RECLAIMER_HPP
+#define FALAFELS_SLACK_RECLAIMER_HPP
+
+#include <cstdint>
+#include <unordered_map>
+#include "../../../protocol.hpp"
+
+/**
+ * Energy-aware DVFS for the trainers of a synchronous aggregator, see Constants::DVFS_LEARNING_ROUNDS.
+ * Over the first rounds, it learns how long each trainer trains and how much earlier than the last one its local model
+ * arrives. Then each trainer host is set to the pstate consuming the least energy while still finishing in time.
+ */
+class SlackReclaimer
+{
+public:
+    /** Called when the global model is sent to the trainers */
+    void start_round();
+
+    /** Called when a local model is received */
+    void record_local_model(const protocol::operations::SendLocalModel &local_model);
+
+    /** Called once every local model of the round was received */
+    void end_round();
+
+    /** Report the energy saved against the change in round time */
+    void print_report();
+private:
+    double round_start_time = 0.0;
+    uint64_t number_rounds = 0;
+
+    /** Arrival time of the local model of each trainer during the current round */
+    std::unordered_map<protocol::node_name, double> arrival_times;
+
+    /** Longest training time observed for each trainer */
+    std::unordered_map<protocol::node_name, double> training_times;
+
+    /** Smallest time a trainer waited for the last local model of a round */
+    std::unordered_map<protocol::node_name, double> slacks;
+
+    bool pstates_assigned = false;
+
+    /** Energy consumed by the trainer hosts at the end of the previous round */
+    double last_trainers_energy = 0.0;
+
+    /** Round durations and trainers energy, before and after pstates were assigned */
+    struct RoundStats
+    {
+        uint64_t number_rounds = 0;
+        double total_duration = 0.0;
+        double total_energy = 0.0;
+    };
+    RoundStats before;
+    RoundStats after;
+
+    /** Pick the pstate of each trainer host */
+    void assign_pstates();
+};
+
+#endif // !FALAFELS_SLACK_RECLAIMER_HPP
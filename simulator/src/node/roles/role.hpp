@@ -3,6 +3,7 @@
 #define FALAFELS_ROLE_HPP
 
 #include "../mediator/mediator_consumer.hpp"
+#include "../../constants.hpp"
 #include <memory>
 
 /**
@@ -18,16 +19,24 @@ protected:
     unique_ptr<MediatorConsumer> mc;
 
     protocol::node_name my_node_name;
+
+    /** Constants of the cluster the Node belongs to */
+    std::shared_ptr<const ClusterConstants> constants = std::make_shared<ClusterConstants>();
 public:
     Role(){}
     virtual ~Role(){} 
 
     void set_mediator_consumer(std::unique_ptr<MediatorConsumer> mc) { this->mc = std::move(mc); }
 
+    void set_constants(std::shared_ptr<const ClusterConstants> constants) { this->constants = constants; }
+
     /* --- Functions to be implemented by the children classes --- */
     virtual void run() = 0;
     virtual protocol::NodeRole get_role_type() = 0;
     /* ----------------------------------------------------------- */
+
+    /** Whether the Role can share its actor with the NetworkManager of its Node, see Constants::FUSE_NODE_ACTORS */
+    virtual bool can_share_actor() { return true; }
 };
 
 #endif // !FALAFELS_ROLE_HPP
@@ -1,12 +1,19 @@
 #include "../../../constants.hpp"
+#include <algorithm>
 #include <cstdint>
 #include <cstdlib>
 #include <memory>
 #include <simgrid/s4u/Actor.hpp>
+#include <simgrid/s4u/Engine.hpp>
 #include <unordered_map>
 #include <variant>
+#include <xbt/asserts.h>
 #include <xbt/log.h>
 #include "trainer.hpp"
+#include "../../../profiler.hpp"
+#include "../../../trace_replay.hpp"
+#include "../../../utils/utils.hpp"
+#include "simgrid/s4u/Disk.hpp"
 #include "simgrid/s4u/Exec.hpp"
 #include "simgrid/s4u/Host.hpp"
 
@@ -21,19 +28,105 @@ Trainer::Trainer(std::unordered_map<std::string, std::string> *args, node_name n
     this->my_node_name = name;
     this->training_activities = new simgrid::s4u::ActivitySet();
 
-    // No arguments yet
+    // Parsing arguments
+    for (auto &[key, value]: *args)
+    {
+        switch (str2int(key.c_str()))
+        {
+            case str2int("dataset_size"):
+            case str2int("samples"):
+                {
+                    this->dataset_size = std::stoull(value);
+                    XBT_INFO("dataset_size=%lu", *this->dataset_size);
+                    break;
+                }
+            case str2int("shard_size_bytes"):
+                {
+                    this->shard_size_bytes = std::stoull(value);
+                    XBT_INFO("shard_size_bytes=%lu", *this->shard_size_bytes);
+                    break;
+                }
+            case str2int("disk"):
+                {
+                    this->disk_name = value;
+                    XBT_INFO("disk=%s", value.c_str());
+                    break;
+                }
+        }
+    }
+
     delete args;
 }
 
+Trainer::~Trainer()
+{
+    delete this->training_activities;
+
+    if (this->number_sleeps != 0)
+        XBT_INFO("Slept %lu times, avoiding %f J of idle energy (%f J per round)", this->number_sleeps,
+                 this->avoided_idle_energy, this->avoided_idle_energy / this->number_sleeps);
+}
+
+double Trainer::get_training_flops_per_core(double flops, int nb_core, uint8_t number_local_epochs)
+{
+    double total_nb_flops_per_epoch = (flops / nb_core) * number_local_epochs;
+
+    XBT_DEBUG("(flops / nb_core) * nb_local_epochs = total_nb_flops_per_epoch <-> (%f / %i) * %u = %f",
+              flops, nb_core, number_local_epochs, total_nb_flops_per_epoch);
+
+    return total_nb_flops_per_epoch;
+}
+
 void Trainer::train() 
 {
-    double flops = Constants::LOCAL_MODEL_TRAINING_FLOPS;
-    
+    double start_time = simgrid::s4u::Engine::get_instance()->get_clock();
+
+    // Number of epochs that have to read the shard from the disk first
+    uint8_t number_cold_epochs = 0;
+
+    if (this->get_shard_size_bytes() != 0)
+    {
+        if (!Constants::DATASET_PAGE_CACHE)
+            number_cold_epochs = this->number_local_epochs;
+        else if (!this->shard_cached && this->number_local_epochs != 0)
+            number_cold_epochs = 1;
+    }
+
+    for (uint8_t i = 0; i < number_cold_epochs; i++)
+    {
+        this->read_shard();
+        this->run_epochs(1);
+    }
+
+    this->shard_cached = Constants::DATASET_PAGE_CACHE && (this->shard_cached || number_cold_epochs != 0);
+
+    // Warm epochs only compute, so they are run as a whole
+    this->run_epochs(this->number_local_epochs - number_cold_epochs);
+
+    double end_time = simgrid::s4u::Engine::get_instance()->get_clock();
+    this->training_time = end_time - start_time;
+
+    if (PhaseProfiler::get_instance().is_enabled())
+        PhaseProfiler::get_instance().record(this->my_node_name, PhaseProfiler::TRAINING, start_time, end_time);
+}
+
+void Trainer::run_epochs(uint8_t number_epochs)
+{
+    if (number_epochs == 0)
+        return;
+
+    xbt_assert(this->constants->REFERENCE_DATASET_SIZE != 0, "REFERENCE_DATASET_SIZE cannot be 0");
+
+    // The training cost is proportional to the number of samples seen by each epoch
+    double dataset_ratio = (double) this->get_dataset_size() / this->constants->REFERENCE_DATASET_SIZE;
+
     int nb_core = simgrid::s4u::this_actor::get_host()->get_core_count();
-    double total_nb_flops_per_epoch = (flops / nb_core) * this->number_local_epochs;
+    double total_nb_flops_per_epoch = Trainer::get_training_flops_per_core(
+        this->constants->LOCAL_MODEL_TRAINING_FLOPS * dataset_ratio, nb_core, number_epochs
+    );
 
-    XBT_DEBUG("(flops / nb_core) * nb_local_epochs = total_nb_flops_per_epoch <-> (%f / %i) * %u = %f",
-              flops, nb_core, this->number_local_epochs, total_nb_flops_per_epoch);
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_compute(total_nb_flops_per_epoch * nb_core);
     
     // TODO: maybe actually use simgrid functions to launch in parallel???
     // Launch exactly nb_core parallel tasks
@@ -43,17 +136,160 @@ void Trainer::train()
         this->training_activities->push(exec);
     }
 
-    this->training_activities->wait_all();
+    this->mc->wait_activities(this->training_activities);
+}
+
+void Trainer::read_shard()
+{
+    auto host = simgrid::s4u::this_actor::get_host();
+    auto disks = host->get_disks();
+
+    auto disk = find_if(disks.begin(), disks.end(), [this](simgrid::s4u::Disk *d) {
+        return !this->disk_name || d->get_name() == *this->disk_name;
+    });
+
+    xbt_assert(disk != disks.end(), "Trainer %s reads its dataset, but host %s has no disk%s",
+               this->my_node_name.c_str(), host->get_cname(),
+               this->disk_name ? (" named " + *this->disk_name).c_str() : "");
+
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_read(this->get_shard_size_bytes(), (*disk)->get_name());
+
+    this->training_activities->push((*disk)->read_async(this->get_shard_size_bytes()));
+    this->mc->wait_activities(this->training_activities);
 }
 
 void Trainer::send_local_model()
 {
     this->mc->put_async_to_be_sent_packet(
         filters::aggregators,
-        operations::SendLocalModel(this->number_local_epochs)
+        operations::SendLocalModel {
+            .number_local_epochs_done = (uint32_t)(this->number_local_epochs * this->multiplicity),
+            .number_local_models = this->multiplicity,
+            .trainer_name = this->my_node_name,
+            .training_time = this->training_time,
+            .model_size_bytes = this->constants->MODEL_SIZE_BYTES,
+            .number_samples = this->get_dataset_size() * this->multiplicity,
+            .reference_dataset_size = this->constants->REFERENCE_DATASET_SIZE,
+            .global_model_version = this->global_model_version,
+        }
     );
 }
 
+/**
+ * Host property holding the pstate of a sleeping host once awake, empty while awake. Kept on the host rather than in
+ * the Trainer so that the SlackReclaimer of the aggregator can change it.
+ */
+static const string AWAKE_PSTATE_PROPERTY = "falafels_awake_pstate";
+
+unsigned long Trainer::get_awake_pstate(simgrid::s4u::Host *host)
+{
+    auto awake_pstate = host->get_property(AWAKE_PSTATE_PROPERTY);
+
+    if (awake_pstate == nullptr || *awake_pstate == '\0')
+        return host->get_pstate();
+
+    return stoul(awake_pstate);
+}
+
+void Trainer::set_awake_pstate(simgrid::s4u::Host *host, unsigned long pstate)
+{
+    auto awake_pstate = host->get_property(AWAKE_PSTATE_PROPERTY);
+
+    if (awake_pstate != nullptr && *awake_pstate != '\0')
+    {
+        host->set_property(AWAKE_PSTATE_PROPERTY, to_string(pstate));
+        return;
+    }
+
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_pstate(host, pstate);
+
+    host->set_pstate(pstate);
+}
+
+void Trainer::fall_asleep()
+{
+    auto host = simgrid::s4u::this_actor::get_host();
+
+    xbt_assert((unsigned long) Constants::TRAINER_SLEEP_PSTATE < host->get_pstate_count(),
+               "TRAINER_SLEEP_PSTATE %ld doesn't exist on host %s", Constants::TRAINER_SLEEP_PSTATE, host->get_cname());
+
+    host->set_property(AWAKE_PSTATE_PROPERTY, to_string(host->get_pstate()));
+    this->asleep = true;
+    this->sleep_start_time = simgrid::s4u::Engine::get_instance()->get_clock();
+
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_pstate(host, Constants::TRAINER_SLEEP_PSTATE);
+
+    host->set_pstate(Constants::TRAINER_SLEEP_PSTATE);
+}
+
+void Trainer::wake_up()
+{
+    auto host = simgrid::s4u::this_actor::get_host();
+
+    // The host is still asleep while it wakes up
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_sleep(Constants::TRAINER_WAKEUP_LATENCY);
+
+    simgrid::s4u::this_actor::sleep_for(Constants::TRAINER_WAKEUP_LATENCY);
+
+    double sleep_duration = simgrid::s4u::Engine::get_instance()->get_clock() - this->sleep_start_time;
+
+    // Possibly changed by the SlackReclaimer while we slept
+    unsigned long awake_pstate = Trainer::get_awake_pstate(host);
+
+    auto awake_wattages = parse_wattages(host->get_property("wattage_per_state"), awake_pstate);
+    auto sleep_wattages = parse_wattages(host->get_property("wattage_per_state"), Constants::TRAINER_SLEEP_PSTATE);
+
+    if (!awake_wattages.empty() && !sleep_wattages.empty())
+    {
+        double avoided = (awake_wattages.front() - sleep_wattages.front()) * sleep_duration 
+                         - Constants::TRAINER_WAKEUP_ENERGY;
+
+        this->avoided_idle_energy += avoided;
+        Trainer::total_avoided_idle_energy += avoided;
+    }
+
+    this->number_sleeps += 1;
+
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_pstate(host, awake_pstate);
+
+    host->set_pstate(awake_pstate);
+    host->set_property(AWAKE_PSTATE_PROPERTY, "");
+    this->asleep = false;
+
+    this->consume_wakeup_energy(awake_wattages);
+}
+
+void Trainer::consume_wakeup_energy(const vector<double> &awake_wattages)
+{
+    if (Constants::TRAINER_WAKEUP_ENERGY == 0.0 || awake_wattages.empty())
+        return;
+
+    auto host = simgrid::s4u::this_actor::get_host();
+    int nb_core = host->get_core_count();
+
+    // Every core is busy during the burst, the host drawing its all cores wattage instead of the idle one it would
+    // have drawn anyway, so the burst lasts until the difference adds up to the wake-up energy
+    double extra_wattage = awake_wattages.back() - awake_wattages.front();
+    xbt_assert(extra_wattage > 0.0, "%s can't consume TRAINER_WAKEUP_ENERGY, its all cores wattage isn't above its idle one",
+               host->get_cname());
+
+    double duration = Constants::TRAINER_WAKEUP_ENERGY / extra_wattage;
+    double flops_per_core = host->get_speed() * duration;
+
+    if (TraceRecorder::get_instance().is_enabled())
+        TraceRecorder::get_instance().record_compute(flops_per_core * nb_core);
+
+    for (int i = 0; i < nb_core; i++)
+        this->training_activities->push(simgrid::s4u::this_actor::exec_async(flops_per_core));
+
+    this->mc->wait_activities(this->training_activities);
+}
+
 void Trainer::run()
 {
     switch (this->state)
@@ -65,8 +301,12 @@ void Trainer::run()
                 // If the operation is a SendGlobalModel
                 if (auto *op_glob = get_if<operations::SendGlobalModel>(op.get()))
                 {
+                    if (this->asleep)
+                        this->wake_up();
+
                     // Set the number of local epochs
                     this->number_local_epochs = op_glob->number_local_epochs;
+                    this->global_model_version = op_glob->version;
                     this->state = TRAINING;
                 }
                 break;
@@ -76,6 +316,9 @@ void Trainer::run()
                 this->train();
                 this->send_local_model();
                 this->state = WAITING_GLOBAL_MODEL;
+
+                if (Constants::TRAINER_SLEEP_PSTATE >= 0)
+                    this->fall_asleep();
                 break;
             }
     }
@@ -3,7 +3,10 @@
 #define FALAFELS_TRAINER_HPP
 
 #include "../role.hpp"
+#include <atomic>
 #include <cstdint>
+#include <optional>
+#include <vector>
 #include <simgrid/forward.h>
 #include <simgrid/s4u/ActivitySet.hpp>
 #include <unordered_map>
@@ -24,21 +27,94 @@ protected:
     /** The total number of local epochs to perform */
     uint8_t number_local_epochs = 0;
 
+    /** Version of the global model we train from, see ConvergenceModel */
+    uint64_t global_model_version = 0;
+
+    /** Number of samples of the local dataset, Constants::REFERENCE_DATASET_SIZE when not given */
+    std::optional<uint64_t> dataset_size;
+
+    /** Size of the shard read before epochs, dataset_size * Constants::DATASET_SAMPLE_SIZE_BYTES when not given */
+    std::optional<uint64_t> shard_size_bytes;
+
+    /** Disk of the host the shard is read from, the first one when not given */
+    std::optional<std::string> disk_name;
+
+    /** Whether the shard is in the page cache of the host, see Constants::DATASET_PAGE_CACHE */
+    bool shard_cached = false;
+
+    /** Number of equivalent trainers we stand for, see Constants::SYMMETRY_REDUCTION */
+    uint32_t multiplicity = 1;
+
+    /** Duration of the last training */
+    double training_time = 0.0;
+
+    /** Whether the host is in Constants::TRAINER_SLEEP_PSTATE, its pstate when awake being kept in a host property */
+    bool asleep = false;
+
+    /** Time at which the host fell asleep */
+    double sleep_start_time = 0.0;
+
+    /** Number of times the host slept, and the idle energy it avoided minus the wake-up energy */
+    uint64_t number_sleeps = 0;
+    double avoided_idle_energy = 0.0;
+
+    /** Sum of avoided_idle_energy over every trainer, reported at the end of the simulation */
+    inline static std::atomic<double> total_avoided_idle_energy = 0.0;
+
     /** Simgrid ActivitySet containing the training tasks */
     simgrid::s4u::ActivitySet *training_activities;
 
     /** Run and wait the training activities in parallel. */
     void train();
 
+    /** Run and wait the training activities of number_epochs epochs in parallel. */
+    void run_epochs(uint8_t number_epochs);
+
+    /** Read the shard of the dataset from the disk of the host */
+    void read_shard();
+
     /** Send the local model to aggregator(s) */
     void send_local_model();
+
+    uint64_t get_dataset_size() { return this->dataset_size.value_or(this->constants->REFERENCE_DATASET_SIZE); }
+
+    uint64_t get_shard_size_bytes()
+    {
+        return this->shard_size_bytes.value_or(this->get_dataset_size() * this->constants->DATASET_SAMPLE_SIZE_BYTES);
+    }
+
+    /** Switch the host to the sleep pstate until the next global model */
+    void fall_asleep();
+
+    /** Switch the host back to its pstate, paying the wake-up latency and energy */
+    void wake_up();
+
+    /** 
+     * Consume Constants::TRAINER_WAKEUP_ENERGY with a burst on every core, given the wattages of the awake pstate. The
+     * energy is what the burst consumes above the idle wattage, which the host would have drawn anyway.
+     */
+    void consume_wakeup_energy(const std::vector<double> &awake_wattages);
 public:
     Trainer(std::unordered_map<std::string, std::string> *args, protocol::node_name);
-    ~Trainer() { delete this->training_activities; };
+    ~Trainer();
 
     /** Run one step of the trainer. */
     void run();
 
+    void set_multiplicity(uint32_t multiplicity) { this->multiplicity = multiplicity; }
+
+    /** Number of flops each core of a host with nb_core cores computes to train a local model of the given cost */
+    static double get_training_flops_per_core(double flops, int nb_core, uint8_t number_local_epochs);
+
+    /** Pstate the host of a trainer has while awake, which differs from its current one while it sleeps */
+    static unsigned long get_awake_pstate(simgrid::s4u::Host *host);
+
+    /** Set the pstate the host of a trainer has while awake, only applied once it wakes up if it sleeps */
+    static void set_awake_pstate(simgrid::s4u::Host *host, unsigned long pstate);
+
+    /** Idle energy avoided by every sleeping trainer so far, see Constants::TRAINER_SLEEP_PSTATE */
+    static double get_total_avoided_idle_energy() { return total_avoided_idle_energy; }
+
     protocol::NodeRole get_role_type() { return protocol::NodeRole::Trainer; };
 };
 
@@ -0,0 +1,475 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <pugixml.hpp>
+#include <simgrid/s4u/Engine.hpp>
+#include <simgrid/s4u/Host.hpp>
+#include <simgrid/s4u/Link.hpp>
+#include <string>
+#include <vector>
+#include <xbt/asserts.h>
+#include <xbt/log.h>
+
+#include "placement.hpp"
+#include "config_loader.hpp"
+#include "constants.hpp"
+#include "estimate.hpp"
+#include "node/roles/aggregator/aggregator.hpp"
+#include "node/roles/trainer/trainer.hpp"
+#include "utils/utils.hpp"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_placement, "Messages specific for this example");
+
+using namespace std;
+using namespace protocol;
+using simgrid::s4u::Host;
+using simgrid::s4u::Link;
+
+/** Bound of the number of times trainers are reassigned and aggregators moved */
+static const int MAX_NUMBER_ITERATIONS = 8;
+
+/** A star cluster of the fried file, whose elements are rewritten in place */
+struct StarCluster
+{
+    pugi::xml_node cluster_elem;
+    pugi::xml_node aggregator_elem;
+    vector<pugi::xml_node> trainer_elems;
+
+    /** Aggregator its aggregated models are sent to, if any */
+    optional<node_name> parent;
+
+    uint8_t number_local_epochs = 3;
+};
+
+/** Profiles of the speed or of the access links of a host describe the host, not the Node running on it */
+static bool is_host_profile(const pugi::xml_node &profile_elem)
+{
+    return strcmp(profile_elem.attribute("target").as_string(), "speed") == 0 || !profile_elem.attribute("link");
+}
+
+/** 
+ * Make the access link profiles of a node name the links they target, which would change once the node gets another
+ * bootstrap node or host.
+ */
+static void name_access_links(pugi::xml_node node_elem)
+{
+    vector<pugi::xml_node> access_link_profile_elems;
+    for (auto profile_elem: node_elem.children("profile"))
+    {
+        if (!profile_elem.attribute("link") && strcmp(profile_elem.attribute("target").as_string(), "speed") != 0)
+            access_link_profile_elems.push_back(profile_elem);
+    }
+
+    for (auto profile_elem: access_link_profile_elems)
+    {
+        for (auto link: get_access_links(&node_elem))
+        {
+            auto named_elem = node_elem.insert_copy_before(profile_elem, profile_elem);
+            named_elem.append_attribute("link").set_value(link->get_cname());
+        }
+
+        node_elem.remove_child(profile_elem);
+    }
+}
+
+static Host *get_host(const pugi::xml_node &node_elem)
+{
+    return simgrid::s4u::Engine::get_instance()->host_by_name(node_elem.attribute("name").as_string());
+}
+
+/** Time to send bytes from src to dst when nothing else uses the route */
+static double get_transfer_time(Host *src, Host *dst, double bytes)
+{
+    vector<Link*> links;
+    double latency = 0.0;
+
+    src->route_to(dst, links, &latency);
+
+    double bottleneck_bandwidth = numeric_limits<double>::infinity();
+    for (auto link: links)
+        bottleneck_bandwidth = min(bottleneck_bandwidth, link->get_bandwidth());
+
+    return latency * LATENCY_FACTOR + bytes / (bottleneck_bandwidth * BANDWIDTH_FACTOR);
+}
+
+static double get_round_trip_time(Host *a, Host *b)
+{
+    return get_transfer_time(a, b, Constants::MODEL_SIZE_BYTES) + get_transfer_time(b, a, Constants::MODEL_SIZE_BYTES);
+}
+
+class DeploymentOptimizer
+{
+public:
+    DeploymentOptimizer(const char *fried_path);
+
+    void optimize(const char *output_path);
+private:
+    pugi::xml_document doc;
+    vector<StarCluster> clusters;
+
+    /** Expected round time of a cluster if its aggregator ran on the given member host */
+    double estimate_round(const StarCluster &cluster, Host *aggregator_host);
+
+    /** Longest expected round time among the clusters, the one of the main aggregator when they run in parallel */
+    double estimate_round();
+
+    /** Move trainers to the cluster of their nearest aggregator. Returns the number of moved trainers */
+    int assign_trainers();
+
+    /** Move aggregators to the member host of their cluster minimizing its round time. Returns the number of moves */
+    int place_aggregators();
+
+    /** Exchange the Nodes of two hosts, every reference to their names included */
+    void swap_hosts(const string &a, const string &b);
+};
+
+DeploymentOptimizer::DeploymentOptimizer(const char *fried_path)
+{
+    xbt_assert(this->doc.load_file(fried_path), "Error while loading fried falafels deployment file");
+
+    for (auto cluster_elem: this->doc.child("fried").children("cluster"))
+    {
+        xbt_assert(!cluster_elem.child("constants"), "Deployment optimization doesn't support clusters with their own constants");
+
+        if (strcmp(cluster_elem.attribute("topology").as_string(), "star") != 0)
+            continue;
+
+        StarCluster cluster { .cluster_elem = cluster_elem };
+
+        for (auto node_elem: cluster_elem.children("node"))
+        {
+            auto role_elem = node_elem.first_child();
+
+            if (strcmp(role_elem.name(), "trainer") == 0)
+            {
+                cluster.trainer_elems.push_back(node_elem);
+                continue;
+            }
+
+            xbt_assert(!cluster.aggregator_elem, "Star cluster with several aggregators");
+            cluster.aggregator_elem = node_elem;
+
+            for (auto arg: role_elem.children())
+            {
+                switch (str2int(arg.attribute("name").as_string()))
+                {
+                    case str2int("number_local_epochs"):
+                        cluster.number_local_epochs = arg.attribute("value").as_int();
+                        break;
+                    case str2int("central_aggregator_name"):
+                    case str2int("parent_aggregator_name"):
+                        cluster.parent = arg.attribute("value").as_string();
+                        break;
+                }
+            }
+        }
+
+        // Clusters only made of the main aggregator of a tree have nothing to place
+        if (cluster.trainer_elems.empty())
+            continue;
+
+        xbt_assert(cluster.aggregator_elem, "Star cluster without aggregator");
+
+        // Host profiles of the cluster apply to the hosts of its trainers, which they should follow when trainers move
+        // or swap their host with the aggregator. Copied before the trainers' own profiles, which still override them.
+        vector<pugi::xml_node> host_profile_elems;
+        for (auto profile_elem: cluster_elem.children("profile"))
+        {
+            if (is_host_profile(profile_elem))
+                host_profile_elems.push_back(profile_elem);
+        }
+
+        for (auto trainer_elem: cluster.trainer_elems)
+        {
+            auto position = trainer_elem.child("network-manager");
+
+            for (auto profile_elem: host_profile_elems)
+                position = trainer_elem.insert_copy_after(profile_elem, position);
+        }
+
+        for (auto profile_elem: host_profile_elems)
+            cluster_elem.remove_child(profile_elem);
+
+        this->clusters.push_back(cluster);
+    }
+}
+
+double DeploymentOptimizer::estimate_round(const StarCluster &cluster, Host *aggregator_host)
+{
+    // The trainer of the chosen host takes the place of the aggregator
+    auto trainer_hosts = vector<Host*> { get_host(cluster.aggregator_elem) };
+    for (auto &trainer_elem: cluster.trainer_elems)
+        trainer_hosts.push_back(get_host(trainer_elem));
+
+    std::erase(trainer_hosts, aggregator_host);
+
+    double slowest_trainer = 0.0;
+
+    for (auto trainer_host: trainer_hosts)
+    {
+        double training_time = Trainer::get_training_flops_per_core(
+            Constants::LOCAL_MODEL_TRAINING_FLOPS, trainer_host->get_core_count(), cluster.number_local_epochs
+        ) / trainer_host->get_speed();
+
+        slowest_trainer = max(slowest_trainer, get_round_trip_time(aggregator_host, trainer_host) + training_time);
+    }
+
+    double aggregating_time = Aggregator::get_aggregating_flops_per_core(
+        Constants::GLOBAL_MODEL_AGGREGATING_FLOPS, aggregator_host->get_core_count(), trainer_hosts.size()
+    ) / aggregator_host->get_speed();
+
+    double parent_exchange = 0.0;
+    if (cluster.parent)
+        parent_exchange = get_round_trip_time(
+            aggregator_host, simgrid::s4u::Engine::get_instance()->host_by_name(*cluster.parent)
+        );
+
+    return slowest_trainer + aggregating_time + parent_exchange;
+}
+
+double DeploymentOptimizer::estimate_round()
+{
+    double round_time = 0.0;
+
+    for (auto &cluster: this->clusters)
+        round_time = max(round_time, this->estimate_round(cluster, get_host(cluster.aggregator_elem)));
+
+    return round_time;
+}
+
+int DeploymentOptimizer::assign_trainers()
+{
+    int number_moves = 0;
+
+    for (size_t from = 0; from < this->clusters.size(); from++)
+    {
+        auto &trainer_elems = this->clusters[from].trainer_elems;
+
+        for (size_t i = 0; i < trainer_elems.size();)
+        {
+            auto trainer_elem = trainer_elems[i];
+            auto trainer_host = get_host(trainer_elem);
+
+            size_t nearest = from;
+            double nearest_time = get_round_trip_time(trainer_host, get_host(this->clusters[from].aggregator_elem));
+
+            for (size_t to = 0; to < this->clusters.size(); to++)
+            {
+                double time = get_round_trip_time(trainer_host, get_host(this->clusters[to].aggregator_elem));
+
+                if (time < nearest_time)
+                {
+                    nearest = to;
+                    nearest_time = time;
+                }
+            }
+
+            // A cluster keeps at least one trainer, otherwise its aggregator would wait forever
+            if (nearest == from || trainer_elems.size() == 1)
+            {
+                i++;
+                continue;
+            }
+
+            auto &target = this->clusters[nearest];
+            auto aggregator_name = target.aggregator_elem.attribute("name").as_string();
+
+            name_access_links(trainer_elem);
+
+            XBT_INFO("Trainer %s moves to the cluster of %s", trainer_elem.attribute("name").as_string(), aggregator_name);
+
+            auto moved_elem = target.cluster_elem.insert_move_before(trainer_elem, target.aggregator_elem);
+            moved_elem.child("network-manager")
+                .find_child_by_attribute("arg", "name", "bootstrap-node")
+                .attribute("value").set_value(aggregator_name);
+
+            target.trainer_elems.push_back(moved_elem);
+            trainer_elems.erase(trainer_elems.begin() + i);
+            number_moves++;
+        }
+    }
+
+    return number_moves;
+}
+
+int DeploymentOptimizer::place_aggregators()
+{
+    int number_moves = 0;
+
+    for (auto &cluster: this->clusters)
+    {
+        auto aggregator_host = get_host(cluster.aggregator_elem);
+
+        Host *best_host = aggregator_host;
+        double best_time = this->estimate_round(cluster, aggregator_host);
+
+        for (auto &trainer_elem: cluster.trainer_elems)
+        {
+            auto candidate = get_host(trainer_elem);
+            double time = this->estimate_round(cluster, candidate);
+
+            if (time < best_time)
+            {
+                best_host = candidate;
+                best_time = time;
+            }
+        }
+
+        if (best_host == aggregator_host)
+            continue;
+
+        XBT_INFO("Aggregator %s moves to %s, expected round time %f s",
+                 aggregator_host->get_cname(), best_host->get_cname(), best_time);
+
+        this->swap_hosts(aggregator_host->get_name(), best_host->get_name());
+        number_moves++;
+    }
+
+    return number_moves;
+}
+
+void DeploymentOptimizer::swap_hosts(const string &a, const string &b)
+{
+    auto swap_value = [&a, &b](pugi::xml_attribute attribute)
+    {
+        if (attribute.as_string() == a)
+            attribute.set_value(b.c_str());
+        else if (attribute.as_string() == b)
+            attribute.set_value(a.c_str());
+    };
+
+    vector<pugi::xml_node> node_elems;
+    vector<pugi::xml_node> host_profile_elems;
+
+    for (auto cluster_elem: this->doc.child("fried").children("cluster"))
+    {
+        for (auto node_elem: cluster_elem.children("node"))
+        {
+            string name = node_elem.attribute("name").as_string();
+
+            if (name != a && name != b)
+                continue;
+
+            node_elems.push_back(node_elem);
+            name_access_links(node_elem);
+
+            for (auto profile_elem: node_elem.children("profile"))
+            {
+                if (is_host_profile(profile_elem))
+                    host_profile_elems.push_back(profile_elem);
+            }
+        }
+    }
+
+    // Nodes are named after their hosts, and their arguments refer to other Nodes by name
+    for (auto cluster_elem: this->doc.child("fried").children("cluster"))
+    {
+        for (auto node_elem: cluster_elem.children("node"))
+        {
+            swap_value(node_elem.attribute("name"));
+
+            for (auto child_elem: node_elem.children())
+                for (auto arg: child_elem.children("arg"))
+                    swap_value(arg.attribute("value"));
+        }
+    }
+
+    // Give host profiles back to the Node now running on their host. Those of a host left without Node are dropped,
+    // as an unused host neither computes nor sends anything.
+    for (auto profile_elem: host_profile_elems)
+    {
+        auto previous_node_elem = profile_elem.parent();
+        string host_name = previous_node_elem.attribute("name").as_string() == a ? b : a;
+
+        for (auto node_elem: node_elems)
+        {
+            if (node_elem.attribute("name").as_string() == host_name)
+                node_elem.append_copy(profile_elem);
+        }
+
+        previous_node_elem.remove_child(profile_elem);
+    }
+}
+
+void DeploymentOptimizer::optimize(const char *output_path)
+{
+    double initial_round_time = this->estimate_round();
+
+    for (int i = 0; i < MAX_NUMBER_ITERATIONS; i++)
+    {
+        int number_moves = this->assign_trainers() + this->place_aggregators();
+
+        if (number_moves == 0)
+            break;
+    }
+
+    auto fried_elem = this->doc.child("fried");
+
+    // Rings can only be ordered once every member registered
+    for (auto cluster_elem: fried_elem.children("cluster"))
+    {
+        if (!string(cluster_elem.attribute("topology").as_string()).starts_with("ring"))
+            continue;
+
+        auto constants_elem = fried_elem.child("constants");
+        if (!constants_elem)
+            constants_elem = fried_elem.prepend_child("constants");
+
+        auto constant_elem = constants_elem.find_child_by_attribute("constant", "name", "RING_ORDER_BY_LATENCY");
+        if (!constant_elem)
+        {
+            constant_elem = constants_elem.append_child("constant");
+            constant_elem.append_attribute("name").set_value("RING_ORDER_BY_LATENCY");
+            constant_elem.append_attribute("value");
+        }
+
+        constant_elem.attribute("value").set_value("1");
+        break;
+    }
+
+    XBT_INFO("Expected round time: %f s before optimization, %f s after", initial_round_time, this->estimate_round());
+
+    xbt_assert(this->doc.save_file(output_path), "Cannot write the optimized deployment to %s", output_path);
+    XBT_INFO("Optimized deployment written to %s", output_path);
+}
+
+void optimize_deployment(const char *fried_path, const char *output_path)
+{
+    DeploymentOptimizer(fried_path).optimize(output_path);
+}
+
+void order_ring_by_latency(const node_name &main_aggregator, queue<operations::RegistrationRequest> &trainers)
+{
+    auto e = simgrid::s4u::Engine::get_instance();
+
+    vector<operations::RegistrationRequest> remaining;
+    for (; !trainers.empty(); trainers.pop())
+        remaining.push_back(trainers.front());
+
+    auto current = e->host_by_name(main_aggregator);
+
+    while (!remaining.empty())
+    {
+        auto nearest = remaining.end();
+        double nearest_latency = numeric_limits<double>::infinity();
+
+        for (auto it = remaining.begin(); it != remaining.end(); it++)
+        {
+            vector<Link*> links;
+            double latency = 0.0;
+
+            current->route_to(e->host_by_name(it->node_to_register.name), links, &latency);
+
+            if (latency < nearest_latency)
+            {
+                nearest = it;
+                nearest_latency = latency;
+            }
+        }
+
+        current = e->host_by_name(nearest->node_to_register.name);
+        trainers.push(*nearest);
+        remaining.erase(nearest);
+    }
+}
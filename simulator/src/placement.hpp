@@ -0,0 +1,36 @@
+#ifndef FALAFELS_PLACEMENT_HPP
+#define FALAFELS_PLACEMENT_HPP
+
+#include <queue>
+
+#include "protocol.hpp"
+
+/**
+ * Rewrite a fried deployment so that it fits the routes of the loaded platform, the constants having to be
+ * initialized from the same fried file:
+ * - Trainers of star clusters join the cluster whose aggregator they reach the fastest.
+ * - The aggregator of each star cluster swaps host with the member of its cluster minimizing the expected round time,
+ *   i.e. the time for its slowest trainer to receive the global model, train and send back its local model, plus
+ *   the aggregation and the exchange with its parent aggregator.
+ * - Rings are ordered by latency when the nodes register, see Constants::RING_ORDER_BY_LATENCY.
+ * Both steps are repeated until the deployment doesn't change anymore.
+ *
+ * Transfers are estimated from the latency and the bottleneck bandwidth of routes following SimGrid's LV08 model,
+ * ignoring the sharing of links between flows.
+ *
+ * @param fried_path Deployment to optimize.
+ * @param output_path Where the rewritten deployment is saved.
+ */
+void optimize_deployment(const char *fried_path, const char *output_path);
+
+/**
+ * Reorder the trainers registering to a ring, going each time to the trainer of least route latency among the
+ * remaining ones, starting from the main aggregator.
+ *
+ * @param main_aggregator Name of the main aggregator of the ring.
+ * @param trainers Registration requests of the trainers, reordered in place.
+ */
+void order_ring_by_latency(const protocol::node_name &main_aggregator,
+                           std::queue<protocol::operations::RegistrationRequest> &trainers);
+
+#endif // !FALAFELS_PLACEMENT_HPP
@@ -0,0 +1,183 @@
+#include <format>
+#include <fstream>
+#include <simgrid/s4u/Engine.hpp>
+#include <simgrid/s4u/Host.hpp>
+#include <simgrid/s4u/Link.hpp>
+#include <simgrid/s4u/NetZone.hpp>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <xbt/asserts.h>
+#include <xbt/log.h>
+#include <pugixml.hpp>
+
+#include "platform.hpp"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_platform, "Messages specific for this example");
+
+using namespace std;
+using namespace pugi;
+
+namespace sg4 = simgrid::s4u;
+
+/** Get a required attribute of an element of the compact platform */
+static string get_attribute(const xml_node &elem, const char *name)
+{
+    auto attribute = elem.attribute(name);
+    xbt_assert(attribute, "Missing attribute '%s' in <%s> of the compact platform", name, elem.name());
+
+    return attribute.as_string();
+}
+
+/** Split a comma separated list, used for the speed of each pstate */
+static vector<string> split_list(const string &list)
+{
+    vector<string> items;
+    stringstream stream(list);
+    string item;
+
+    while (getline(stream, item, ','))
+        items.push_back(item);
+
+    return items;
+}
+
+static sg4::Link::SharingPolicy parse_sharing_policy(const string &policy)
+{
+    if (policy == "FATPIPE")
+        return sg4::Link::SharingPolicy::FATPIPE;
+    else if (policy == "SPLITDUPLEX")
+        xbt_die("SPLITDUPLEX links aren't supported in compact platforms");
+
+    xbt_assert(policy == "SHARED", "Unknown sharing policy '%s'", policy.c_str());
+    return sg4::Link::SharingPolicy::SHARED;
+}
+
+/** Create a link from a <link-profile> or <backbone> element */
+static const sg4::Link *create_link(sg4::NetZone *zone, const string &name, const xml_node &profile)
+{
+    auto link = zone->create_link(name, get_attribute(profile, "bandwidth"))
+                    ->set_latency(get_attribute(profile, "latency"))
+                    ->set_sharing_policy(parse_sharing_policy(profile.attribute("sharing").as_string("SHARED")));
+
+    if (auto wattage_range = profile.attribute("wattage_range"))
+        link->set_property("wattage_range", wattage_range.as_string());
+
+    return link->seal();
+}
+
+/**
+ * Build a compact platform through the s4u NetZone API, which spares parsing and routing every host and link of a
+ * large platform. The format is the following:
+ *
+ * <compact-platform version="0.1">
+ *     <host-profile id="rpi" speed="14.4Gf,7.2Gf" core="4" wattage_per_state="2.89:3.0:7.28, 2.0:2.5:5.0"/>
+ *     <link-profile id="wifi" bandwidth="18KBps" latency="570us" wattage_range="15.0:30.0"/>
+ *     <backbone bandwidth="1.25GBps" latency="20us"/>
+ *     <cluster count="10" hosts="100" host-profile="rpi" link-profile="wifi"/>
+ * </compact-platform>
+ *
+ * Each cluster is a star zone where every host has its own link of the link profile, connected to the other clusters 
+ * by an uplink of the backbone. Hosts are named `{name-prefix}{i}`, "Node " followed by a number starting at 1 by 
+ * default, counting across clusters in the order of the file like the fryer does.
+ */
+static void build_compact_platform(const xml_node &platform)
+{
+    unordered_map<string, xml_node> host_profiles;
+    unordered_map<string, xml_node> link_profiles;
+
+    for (auto profile: platform.children("host-profile"))
+        host_profiles[get_attribute(profile, "id")] = profile;
+
+    for (auto profile: platform.children("link-profile"))
+        link_profiles[get_attribute(profile, "id")] = profile;
+
+    auto backbone = platform.child("backbone");
+    xbt_assert(backbone, "Missing <backbone> in the compact platform");
+
+    // The first zone created is the root of the platform
+    auto root = sg4::create_star_zone("backbone");
+
+    const string name_prefix = platform.attribute("name-prefix").as_string("Node ");
+    uint64_t host_number = 1;
+    uint64_t cluster_number = 0;
+
+    for (auto cluster_elem: platform.children("cluster"))
+    {
+        auto host_profile = host_profiles.find(get_attribute(cluster_elem, "host-profile"));
+        auto link_profile = link_profiles.find(get_attribute(cluster_elem, "link-profile"));
+
+        xbt_assert(host_profile != host_profiles.end(), "Unknown host profile '%s'", cluster_elem.attribute("host-profile").as_string());
+        xbt_assert(link_profile != link_profiles.end(), "Unknown link profile '%s'", cluster_elem.attribute("link-profile").as_string());
+
+        auto speeds = split_list(get_attribute(host_profile->second, "speed"));
+        int core = host_profile->second.attribute("core").as_int(1);
+        auto wattage_per_state = host_profile->second.attribute("wattage_per_state");
+        auto wattage_off = host_profile->second.attribute("wattage_off");
+
+        for (uint64_t i = 0; i < cluster_elem.attribute("count").as_ullong(1); i++, cluster_number++)
+        {
+            auto zone = sg4::create_star_zone(std::format("cluster-{}", cluster_number));
+            zone->set_parent(root);
+
+            auto gateway = zone->create_router(std::format("cluster-{}-router", cluster_number));
+            zone->set_gateway(gateway);
+            zone->add_route(gateway, nullptr, nullptr, nullptr, {}, true);
+
+            for (uint64_t j = 0; j < cluster_elem.attribute("hosts").as_ullong(); j++, host_number++)
+            {
+                auto name = std::format("{}{}", name_prefix, host_number);
+
+                auto host = zone->create_host(name, speeds)->set_core_count(core);
+
+                if (wattage_per_state)
+                    host->set_property("wattage_per_state", wattage_per_state.as_string());
+                if (wattage_off)
+                    host->set_property("wattage_off", wattage_off.as_string());
+
+                host->seal();
+
+                auto link = create_link(zone, std::format("{}-link", name), link_profile->second);
+                zone->add_route(host->get_netpoint(), nullptr, nullptr, nullptr, { sg4::LinkInRoute(link) }, true);
+            }
+
+            zone->seal();
+
+            auto uplink = create_link(root, std::format("cluster-{}-uplink", cluster_number), backbone);
+            root->add_route(zone->get_netpoint(), nullptr, gateway, nullptr, { sg4::LinkInRoute(uplink) }, true);
+        }
+    }
+
+    root->seal();
+
+    XBT_INFO("Built compact platform: %lu clusters, %lu hosts", cluster_number, host_number - 1);
+}
+
+/** Whether the file starts as a compact platform, without parsing the whole file as SimGrid platforms can be large */
+static bool is_compact_platform(const char *file_path)
+{
+    ifstream file(file_path);
+    string beginning(4096, '\0');
+
+    file.read(beginning.data(), beginning.size());
+    beginning.resize(file.gcount());
+
+    return beginning.find("<compact-platform") != string::npos;
+}
+
+void load_platform(const char *file_path)
+{
+    if (!is_compact_platform(file_path))
+    {
+        sg4::Engine::get_instance()->load_platform(file_path);
+        return;
+    }
+
+    xml_document doc;
+    xml_parse_result result = doc.load_file(file_path);
+
+    xbt_assert(result != 0, "Error while loading compact platform file");
+
+    build_compact_platform(doc.child("compact-platform"));
+}
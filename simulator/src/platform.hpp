@@ -0,0 +1,12 @@
+#ifndef FALAFELS_PLATFORM_HPP
+#define FALAFELS_PLATFORM_HPP
+
+/**
+ * Load a platform file. SimGrid platforms are loaded by the engine, compact platforms are built through the s4u
+ * NetZone API, see build_compact_platform().
+ *
+ * @param file_path path to the platform file.
+ */
+void load_platform(const char *file_path);
+
+#endif // !FALAFELS_PLATFORM_HPP
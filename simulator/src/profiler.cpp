@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <simgrid/s4u/Actor.hpp>
+#include <simgrid/s4u/Engine.hpp>
+#include <simgrid/s4u/Host.hpp>
+#include <vector>
+#include <xbt/log.h>
+
+#include "critical_path.hpp"
+#include "profiler.hpp"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_profiler, "Messages specific for this example");
+
+using namespace std;
+using namespace protocol;
+
+void PhaseProfiler::enable(string output_dir)
+{
+    this->enabled = true;
+    this->output_dir = output_dir;
+}
+
+void PhaseProfiler::start_round(node_name node)
+{
+    std::lock_guard lock(this->mutex);
+    this->current_rounds[node] += 1;
+}
+
+PhaseProfiler::Interval &PhaseProfiler::get_interval(node_name node, Phase phase)
+{
+    return this->records[{ node, this->current_rounds[node] }].phases[phase];
+}
+
+void PhaseProfiler::record(node_name node, Phase phase, double start, double end)
+{
+    std::lock_guard lock(this->mutex);
+
+    auto &interval = this->get_interval(node, phase);
+    interval.start = min(interval.start, start);
+    interval.end = max(interval.end, end);
+
+    // Computations are always recorded by the node performing them
+    if (phase == TRAINING || phase == AGGREGATION)
+    {
+        auto host = simgrid::s4u::this_actor::get_host();
+        this->hosts[node] = host;
+        this->computations.push_back(Computation { node, host, phase, start, end });
+    }
+}
+
+void PhaseProfiler::record_transfer(const Packet &p, node_name receiver)
+{
+    std::lock_guard lock(this->mutex);
+
+    this->hosts[receiver] = simgrid::s4u::this_actor::get_host();
+    this->transfers.push_back(Transfer {
+        p.id, p.src, receiver, p.original_src, holds_alternative<operations::SendLocalModel>(p.op),
+        holds_alternative<operations::SendGlobalModel>(p.op),
+        p.hop_send_time, simgrid::s4u::Engine::get_instance()->get_clock()
+    });
+}
+
+void PhaseProfiler::register_host(node_name node, simgrid::s4u::Host *host)
+{
+    std::lock_guard lock(this->mutex);
+    this->hosts[node] = host;
+}
+
+simgrid::s4u::Host *PhaseProfiler::get_host(const node_name &node)
+{
+    auto it = this->hosts.find(node);
+    return it != this->hosts.end() ? it->second : nullptr;
+}
+
+void PhaseProfiler::record_upload(node_name node, node_name dst, double start, double end)
+{
+    this->record(node, UPLOAD, start, end);
+
+    std::lock_guard lock(this->mutex);
+    this->records[{ node, this->current_rounds[node] }].uploaded_to = dst;
+}
+
+/** Format a time, leaving the field empty when the phase didn't happen */
+static string format_time(bool is_set, double time)
+{
+    return is_set ? std::format("{}", time) : "";
+}
+
+void PhaseProfiler::write_phases()
+{
+    ofstream file(std::format("{}/phases.csv", this->output_dir));
+
+    file << "node,round,training_start,training_end,upload_start,upload_end,wait,"
+         << "aggregation_start,aggregation_end,broadcast_start,broadcast_end\n";
+
+    for (auto it = this->records.begin(); it != this->records.end(); it++)
+    {
+        auto &[key, record] = *it;
+        auto &[node, round] = key;
+
+        auto &training = record.phases[TRAINING];
+        auto &upload = record.phases[UPLOAD];
+        auto &aggregation = record.phases[AGGREGATION];
+        auto &broadcast = record.phases[BROADCAST];
+
+        // Aggregators wait for local models after broadcasting, trainers wait for the next global model after uploading
+        string wait = "";
+        auto next = std::next(it);
+
+        if (aggregation.is_set() && broadcast.is_set())
+            wait = std::format("{}", aggregation.start - broadcast.start);
+        else if (upload.is_set() && next != this->records.end() && next->first.first == node 
+                 && next->second.phases[BROADCAST].is_set())
+            wait = std::format("{}", next->second.phases[BROADCAST].end - upload.start);
+
+        file << std::format(
+            "{},{},{},{},{},{},{},{},{},{},{}\n", node, round,
+            format_time(training.is_set(), training.start), format_time(training.is_set(), training.end),
+            format_time(upload.is_set(), upload.start), format_time(upload.is_set(), upload.end),
+            wait,
+            format_time(aggregation.is_set(), aggregation.start), format_time(aggregation.is_set(), aggregation.end),
+            format_time(broadcast.is_set(), broadcast.start), format_time(broadcast.is_set(), broadcast.end)
+        );
+    }
+}
+
+void PhaseProfiler::write_rounds()
+{
+    ofstream file(std::format("{}/rounds.csv", this->output_dir));
+
+    file << "aggregator,round,duration,slowest_trainer,download,training,upload,aggregation,straggler_delay,"
+         << "aggregator_utilization,bound\n";
+
+    uint64_t nb_compute_bound = 0, nb_communication_bound = 0, nb_straggler_bound = 0;
+
+    // Nodes whose local model of a round was aggregated by an aggregator, grouped in a single pass over the records
+    map<pair<node_name, uint32_t>, vector<pair<node_name, const RoundRecord*>>> members_by_round;
+
+    for (auto &[member_key, member_record] : this->records)
+    {
+        if (member_record.phases[UPLOAD].is_set())
+            members_by_round[{ member_record.uploaded_to, member_key.second }].push_back({ member_key.first, &member_record });
+    }
+
+    for (auto &[key, record] : this->records)
+    {
+        auto &[aggregator, round] = key;
+
+        auto &aggregation = record.phases[AGGREGATION];
+        auto &broadcast = record.phases[BROADCAST];
+
+        if (!aggregation.is_set() || !broadcast.is_set())
+            continue;
+
+        auto members_it = members_by_round.find(key);
+
+        if (members_it == members_by_round.end())
+            continue;
+
+        auto &members = members_it->second;
+
+        vector<double> upload_ends;
+        for (auto &[_, member_record] : members)
+            upload_ends.push_back(member_record->phases[UPLOAD].end);
+
+        sort(upload_ends.begin(), upload_ends.end());
+
+        // The critical path goes through the trainer whose local model arrived last
+        auto &[slowest_name, slowest] = *max_element(members.begin(), members.end(), [](auto &a, auto &b) {
+            return a.second->phases[UPLOAD].end < b.second->phases[UPLOAD].end;
+        });
+
+        double duration = aggregation.end - broadcast.start;
+        double download = slowest->phases[BROADCAST].duration();
+        double training = slowest->phases[TRAINING].duration();
+        double upload = slowest->phases[UPLOAD].duration();
+        double straggler_delay = upload_ends.back() - upload_ends[upload_ends.size() / 2];
+
+        double compute = training + aggregation.duration();
+        double communication = download + upload;
+
+        string bound;
+        if (straggler_delay > compute && straggler_delay > communication)
+        {
+            bound = "straggler";
+            nb_straggler_bound += 1;
+        }
+        else if (communication > compute)
+        {
+            bound = "communication";
+            nb_communication_bound += 1;
+        }
+        else
+        {
+            bound = "compute";
+            nb_compute_bound += 1;
+        }
+
+        file << std::format(
+            "{},{},{},{},{},{},{},{},{},{},{}\n", aggregator, round, duration, slowest_name, download, training, upload,
+            aggregation.duration(), straggler_delay, duration > 0.0 ? aggregation.duration() / duration : 0.0, bound
+        );
+    }
+
+    XBT_INFO("Profiled rounds: %lu compute-bound, %lu communication-bound, %lu straggler-bound", 
+             nb_compute_bound, nb_communication_bound, nb_straggler_bound);
+}
+
+void PhaseProfiler::generate_profile()
+{
+    std::lock_guard lock(this->mutex);
+
+    filesystem::create_directories(this->output_dir);
+
+    this->write_phases();
+    this->write_rounds();
+
+    CriticalPathAnalyzer(*this).analyze(this->output_dir);
+
+    XBT_INFO("Phase profile written to %s", this->output_dir.c_str());
+}
@@ -0,0 +1,138 @@
+#ifndef FALAFELS_PROFILER_HPP
+#define FALAFELS_PROFILER_HPP
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <simgrid/forward.h>
+#include <utility>
+#include <vector>
+
+#include "protocol.hpp"
+
+/**
+ * Singleton recording when each node goes through the phases of every round, enabled with --profile=DIR.
+ * A node's round starts when it sends (aggregators) or receives (trainers) a global model.
+ * At the end of the simulation, it writes one row per (node, round) in DIR/phases.csv, and per-round metrics of
+ * every aggregator in DIR/rounds.csv, telling whether rounds are compute-bound, communication-bound or
+ * straggler-bound. The raw computations and transfers are kept for CriticalPathAnalyzer.
+ */
+class PhaseProfiler
+{
+public:
+    static PhaseProfiler& get_instance()
+    {
+        static PhaseProfiler instance; 
+        return instance;
+    }
+
+    PhaseProfiler(PhaseProfiler const&) = delete;
+    void operator=(PhaseProfiler const&) = delete;
+
+    enum Phase
+    {
+        /** Local training of a trainer */
+        TRAINING,
+        /** Transfer of a local model, from its sending to its reception */
+        UPLOAD,
+        /** Aggregation of the local models by an aggregator */
+        AGGREGATION,
+        /** Transfers of a global model: to every trainer for an aggregator, to itself for a trainer */
+        BROADCAST,
+        NUMBER_PHASES,
+    };
+
+    /** Start recording, must be called before the simulation starts */
+    void enable(std::string output_dir);
+
+    bool is_enabled() { return this->enabled; }
+
+    /** Start a new round for the given node */
+    void start_round(protocol::node_name node);
+
+    /** Record a phase of the current round of a node, extending it if it was already recorded */
+    void record(protocol::node_name node, Phase phase, double start, double end);
+
+    /** Record the upload of a local model, along with its destination */
+    void record_upload(protocol::node_name node, protocol::node_name dst, double start, double end);
+
+    /** Record the arrival of a packet at one of its hops */
+    void record_transfer(const protocol::Packet &p, protocol::node_name receiver);
+
+    /** Remember the host of a node, NetworkManagers of parent links having their own names */
+    void register_host(protocol::node_name node, simgrid::s4u::Host *host);
+
+    /** Write the profile files and log a summary */
+    void generate_profile();
+
+    /** Training or aggregation performed by a node */
+    struct Computation
+    {
+        protocol::node_name node;
+        simgrid::s4u::Host *host;
+        Phase phase;
+        double start;
+        double end;
+    };
+
+    /** Hop of a packet, from its sending by src to its reception by dst */
+    struct Transfer
+    {
+        protocol::packet_id id;
+        protocol::node_name src;
+        protocol::node_name dst;
+        protocol::node_name original_src;
+        bool is_local_model;
+        bool is_global_model;
+        double start;
+        double end;
+    };
+
+    const std::vector<Computation> &get_computations() { return this->computations; }
+    const std::vector<Transfer> &get_transfers() { return this->transfers; }
+
+    /** Host of a node, nullptr if it never sent anything */
+    simgrid::s4u::Host *get_host(const protocol::node_name &node);
+private:
+    PhaseProfiler() {}
+
+    struct Interval
+    {
+        double start = std::numeric_limits<double>::infinity();
+        double end = -std::numeric_limits<double>::infinity();
+
+        bool is_set() const { return this->start <= this->end; }
+        double duration() const { return this->is_set() ? this->end - this->start : 0.0; }
+    };
+
+    struct RoundRecord
+    {
+        Interval phases[NUMBER_PHASES];
+
+        /** Node the local model was uploaded to */
+        protocol::node_name uploaded_to;
+    };
+
+    Interval &get_interval(protocol::node_name node, Phase phase);
+
+    bool enabled = false;
+    std::string output_dir;
+
+    /** Protects the fields below, as nodes may record from parallel threads */
+    std::mutex mutex;
+
+    std::unordered_map<protocol::node_name, uint32_t> current_rounds;
+    std::map<std::pair<protocol::node_name, uint32_t>, RoundRecord> records;
+
+    std::vector<Computation> computations;
+    std::vector<Transfer> transfers;
+    std::unordered_map<protocol::node_name, simgrid::s4u::Host*> hosts;
+
+    void write_phases();
+    void write_rounds();
+};
+
+#endif // !FALAFELS_PROFILER_HPP
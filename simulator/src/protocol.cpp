@@ -29,8 +29,13 @@ Packet::Packet(filters::NodeFilter target_filter, Operation op) :
 
 void Packet::init()
 {
-    this->id = this->total_packet_number;
-    this->total_packet_number += 1;
+    this->id = Packet::total_packet_number.fetch_add(1, std::memory_order_relaxed);
+}
+
+/** Models carry the size of their cluster's model, or 0 for the global one */
+static uint64_t get_model_size(uint64_t model_size_bytes)
+{
+    return model_size_bytes != 0 ? model_size_bytes : Constants::MODEL_SIZE_BYTES;
 }
 
 /**
@@ -54,25 +59,41 @@ uint64_t Packet::get_packet_size()
             sizeof(this->id);
 
         std::visit(overloaded {
-            [result](RegistrationConfirmation op) mutable
+            [&result](RegistrationConfirmation op)
             {
                 result += sizeof(NodeInfo) * op.node_list->size();
             },
-            [result](SendGlobalModel op) mutable
+            [&result](SendGlobalModel op)
             {
-                result += Constants::MODEL_SIZE_BYTES + sizeof(uint8_t);
+                result += get_model_size(op.model_size_bytes) + sizeof(uint8_t);
             },
-            [result](Kill op) mutable
+            [&result](Kill op)
             {
                 // No arguments...
             },
-            [result](RegistrationRequest op) mutable
+            [&result](RegistrationRequest op)
             {
                 result += sizeof(NodeInfo);
             },
-            [result](SendLocalModel op) mutable
+            [&result](SendLocalModel op)
+            {
+                result += get_model_size(op.model_size_bytes);
+
+                // The weight only needs to be sent when it can't be derived from the number of models, i.e. when
+                // trainers have heterogeneous dataset sizes, so that homogeneous deployments keep their packet sizes
+                uint64_t reference_dataset_size = op.reference_dataset_size != 0 ? op.reference_dataset_size 
+                                                                                 : Constants::REFERENCE_DATASET_SIZE;
+
+                if (op.number_samples != 0 && op.number_samples != op.number_local_models * reference_dataset_size)
+                    result += sizeof(op.number_samples);
+            },
+            [&result](MembershipChange op)
             {
-                result += Constants::MODEL_SIZE_BYTES;
+                // Local to a Node
+            },
+            [&result](EndConditionReached op)
+            {
+                // No arguments...
             }
         }, this->op);
 
@@ -82,6 +103,13 @@ uint64_t Packet::get_packet_size()
     return this->packet_size;
 }
 
+void Packet::set_chunk(uint32_t index, uint32_t nb_chunks, uint64_t chunk_size)
+{
+    this->chunk_index = index;
+    this->nb_chunks = nb_chunks;
+    this->packet_size = chunk_size;
+}
+
 const char *Packet::get_op_name() const
 {
     return std::visit(
@@ -99,23 +127,6 @@ const char *Packet::get_op_name() const
  */
 Packet *Packet::clone()
 {
-    Packet *res;
-
-    if (this->target_filter)
-    {
-        res = new Packet(*this->target_filter, this->op);
-    }
-    else
-    {
-        res = new Packet(this->dst, this->final_dst, this->op);
-    }
-
-    res->id = this->id;
-    res->packet_size = this->packet_size;
-    res->nb_hops = this->nb_hops;
-
-    // Decrement the total packet number because a clone isn't considered as a new packet
-    Packet::total_packet_number -= 1;
-    
-    return res;
+    // Copying doesn't go through init(), because a clone isn't considered as a new packet
+    return new Packet(*this);
 }
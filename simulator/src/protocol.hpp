@@ -1,6 +1,7 @@
 #ifndef FALAFELS_PROTOCOL_HPP
 #define FALAFELS_PROTOCOL_HPP
 
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -30,6 +31,7 @@ struct NodeInfo
 {
     node_name name;
     NodeRole role;
+    uint32_t multiplicity = 1; // number of equivalent trainers simulated by this node, see Constants::SYMMETRY_REDUCTION
 };
 
 
@@ -71,6 +73,8 @@ namespace operations {
     struct SendGlobalModel
     {
         uint8_t number_local_epochs; // number of local epochs the trainer should perform.
+        uint64_t model_size_bytes = 0; // simulated size of the model, 0 for Constants::MODEL_SIZE_BYTES
+        uint64_t version = 0; // number of aggregations the sender did before producing this model
         // static constexpr std::string_view op_name = "SEND_GLOBAL_MODEL\0";
         static constexpr std::string_view op_name = "\x1B[34mSEND_GLOBAL_MODEL\033[0m\0";
     };
@@ -90,10 +94,38 @@ namespace operations {
 
     struct SendLocalModel 
     {
-        uint8_t number_local_epochs_done; // the number of local epochs that the trainer actually did.
+        uint32_t number_local_epochs_done; // the number of local epochs that the trainer (or the subtree of an aggregator) actually did.
+        uint32_t number_local_models = 1; // the number of local models this one stands for, see Constants::SYMMETRY_REDUCTION
+        node_name trainer_name = ""; // the trainer that sent it, empty for partial aggregates
+        double training_time = 0.0; // how long the training took, in seconds
+        uint64_t model_size_bytes = 0; // simulated size of the model, 0 for Constants::MODEL_SIZE_BYTES
+        uint64_t number_samples = 0; // the number of samples the model was trained on, its weight in the aggregation
+        uint64_t reference_dataset_size = 0; // REFERENCE_DATASET_SIZE of the sender's cluster, 0 for Constants::REFERENCE_DATASET_SIZE
+        uint64_t global_model_version = 0; // version of the global model it was trained from
+        double effective_epochs = 0.0; // for partial aggregates, the effective epochs of their aggregation, see ConvergenceModel
         // static constexpr std::string_view op_name = "SEND_LOCAL_MODEL\0";
         static constexpr std::string_view op_name = "\x1B[32mSEND_LOCAL_MODEL\033[0m\0";
     };
+
+    /** 
+     * Never sent through the network: put by a NetworkManager for its Role when a node of its cluster departs or
+     * (re)joins, along the received operations so that Roles waiting for local models notice it.
+     */
+    struct MembershipChange
+    {
+        NodeInfo node; // the node that departed or joined
+        bool joined; // false when the node departed
+        static constexpr std::string_view op_name = "\x1B[35mMEMBERSHIP_CHANGE\033[0m\0";
+    };
+
+    /** 
+     * Only sent by the main aggregator's EndConditionWatcher to its own Node, when the duration of the training phase
+     * or the energy budget is exhausted.
+     */
+    struct EndConditionReached
+    {
+        static constexpr std::string_view op_name = "\x1B[31mEND_CONDITION_REACHED\033[0m\0";
+    };
     /* -------------------------------------------------------------------------------------------- */ 
 
     // Definition of our Operation variant
@@ -102,7 +134,9 @@ namespace operations {
         SendGlobalModel,
         Kill,
         RegistrationRequest,
-        SendLocalModel
+        SendLocalModel,
+        MembershipChange,
+        EndConditionReached
     >;
 };
 
@@ -135,6 +169,18 @@ public:
     /** used in p2p scenario when you want to count the hops from a redirected packet */
     uint32_t nb_hops = 0;
 
+    /** Position of this packet among the chunks of a packet that was split for a pipelined transfer */
+    uint32_t chunk_index = 0;
+
+    /** Number of chunks the original packet was split into, 1 when the packet isn't split */
+    uint32_t nb_chunks = 1;
+
+    /** Simulated time at which the original source sent the packet */
+    double send_time = 0.0;
+
+    /** Simulated time at which the packet was sent by its current src, differs from send_time when redirected */
+    double hop_send_time = 0.0;
+
     /** Clone a packet. Note that pointers in the data variant are also cloned, thus the pointed value will be accessible
      * both by the cloned packet and the original one. */
     Packet *clone();
@@ -153,13 +199,22 @@ public:
     /** Get the printable name of Packet's Operation */
     const char* get_op_name() const;
 
+    /** Turn this packet into the chunk number index out of nb_chunks, carrying chunk_size bytes of the original packet */
+    void set_chunk(uint32_t index, uint32_t nb_chunks, uint64_t chunk_size);
+
+    /** Number of packets created since the start of the simulation */
+    static packet_id get_total_packet_number() { return total_packet_number; }
+
+    /** Whether this packet is complete, or the last chunk of a split packet, meaning the whole packet has been received */
+    bool is_last_chunk() const { return this->chunk_index == this->nb_chunks - 1; }
+
     // void attach_broadcast_filter(BroadcastOpTable);
 private:
     /** Intialize fields of a packet */
     void init();
 
-    /** Use to generate new packet ids */
-    static inline packet_id total_packet_number = 0;
+    /** Use to generate new packet ids, atomic because actors may run in parallel threads */
+    static inline std::atomic<packet_id> total_packet_number = 0;
 
     /** Cache variable to prevent computing the packet's size multiple times */
     uint64_t packet_size = 0;
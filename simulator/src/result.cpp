@@ -0,0 +1,359 @@
+#include "result.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <pugixml.hpp>
+#include <simgrid/plugins/energy.h>
+#include <simgrid/s4u/Disk.hpp>
+#include <simgrid/s4u/Engine.hpp>
+#include <simgrid/s4u/Host.hpp>
+#include <simgrid/s4u/Link.hpp>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <unistd.h>
+#include <unordered_set>
+#include <vector>
+#include <xbt/asserts.h>
+#include <xbt/log.h>
+
+#include "symmetry.hpp"
+#include "utils/utils.hpp"
+
+// Generated by CMake at build time from the project version and git describe
+#include "falafels_version.hpp"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_result, "Messages specific for this example");
+
+using namespace std;
+
+/** Set once before the simulation runs, only read afterwards */
+static unordered_set<string> used_hosts_set;
+
+/** Rounds extrapolated by each main aggregator, i.e. by each job */
+struct Extrapolation
+{
+    uint64_t number_rounds;
+    SimulationResult round_delta;
+};
+
+static map<string, Extrapolation> extrapolations;
+static mutex extrapolations_mutex;
+
+void SimulationResult::set_used_hosts(const vector<string> &used_hosts)
+{
+    used_hosts_set = unordered_set<string>(used_hosts.begin(), used_hosts.end());
+}
+
+SimulationResult SimulationResult::collect()
+{
+    auto e = simgrid::s4u::Engine::get_instance();
+
+    SimulationResult result;
+    result.simulation_time = e->get_clock();
+
+    for (auto host: e->get_all_hosts())
+    {
+        double energy = sg_host_get_consumed_energy(host);
+
+        // Shadows of a representative would have consumed the same energy, see Constants::SYMMETRY_REDUCTION
+        auto representative = SymmetryReduction::get_instance().get_representative(host->get_name());
+        if (representative.has_value())
+            energy = sg_host_get_consumed_energy(e->host_by_name(*representative));
+
+        result.total_host_consumption += energy;
+
+        if (used_hosts_set.contains(host->get_name()) || representative.has_value())
+            result.used_host_consumption += energy;
+        else
+            result.idle_host_consumption += energy;
+    }
+
+    for (auto link: e->get_all_links())
+    {
+        result.total_link_consumption += sg_link_get_consumed_energy(link);
+    }
+
+    for (auto host: e->get_all_hosts())
+    {
+        for (auto disk: host->get_disks())
+            result.total_disk_consumption += sg_disk_get_consumed_energy(disk);
+    }
+
+    return result;
+}
+
+void SimulationResult::set_extrapolation(const string &aggregator_name, uint64_t number_rounds,
+                                         const SimulationResult &round_delta)
+{
+    lock_guard lock(extrapolations_mutex);
+    extrapolations[aggregator_name] = Extrapolation { .number_rounds=number_rounds, .round_delta=round_delta };
+}
+
+void SimulationResult::apply_extrapolation()
+{
+    // Jobs run concurrently and each round delta covers the whole platform, so the extrapolated rounds of the jobs
+    // overlap: only the longest extrapolation is added, it already includes the consumption of the other jobs
+    const Extrapolation *longest = nullptr;
+
+    for (auto &[_, extrapolation]: extrapolations)
+    {
+        double duration = extrapolation.number_rounds * extrapolation.round_delta.simulation_time;
+
+        if (extrapolation.number_rounds != 0
+            && (longest == nullptr || duration > longest->number_rounds * longest->round_delta.simulation_time))
+            longest = &extrapolation;
+    }
+
+    if (longest == nullptr)
+        return;
+
+    auto &delta = longest->round_delta;
+    uint64_t number_rounds = longest->number_rounds;
+
+    this->simulation_time += number_rounds * delta.simulation_time;
+    this->total_host_consumption += number_rounds * delta.total_host_consumption;
+    this->used_host_consumption += number_rounds * delta.used_host_consumption;
+    this->idle_host_consumption += number_rounds * delta.idle_host_consumption;
+    this->total_link_consumption += number_rounds * delta.total_link_consumption;
+    this->total_disk_consumption += number_rounds * delta.total_disk_consumption;
+    this->extrapolated = true;
+}
+
+bool SimulationResult::agrees_with(const SimulationResult &other, double tolerance) const
+{
+    auto agrees = [tolerance](double a, double b) { return abs(a - b) <= tolerance * abs(b); };
+
+    return agrees(this->simulation_time, other.simulation_time)
+        && agrees(this->total_host_consumption, other.total_host_consumption)
+        && agrees(this->used_host_consumption, other.used_host_consumption)
+        && agrees(this->idle_host_consumption, other.idle_host_consumption)
+        && agrees(this->total_link_consumption, other.total_link_consumption)
+        && agrees(this->total_disk_consumption, other.total_disk_consumption);
+}
+
+SimulationResult SimulationResult::operator-(const SimulationResult &other) const
+{
+    return SimulationResult {
+        .simulation_time = this->simulation_time - other.simulation_time,
+        .total_host_consumption = this->total_host_consumption - other.total_host_consumption,
+        .used_host_consumption = this->used_host_consumption - other.used_host_consumption,
+        .idle_host_consumption = this->idle_host_consumption - other.idle_host_consumption,
+        .total_link_consumption = this->total_link_consumption - other.total_link_consumption,
+        .total_disk_consumption = this->total_disk_consumption - other.total_disk_consumption,
+    };
+}
+
+string SimulationResult::serialize() const
+{
+    return std::format(
+        "simulation_time={} total_host_consumption={} used_host_consumption={} idle_host_consumption={} total_link_consumption={} "
+        "total_disk_consumption={} extrapolated={}",
+        this->simulation_time,
+        this->total_host_consumption,
+        this->used_host_consumption,
+        this->idle_host_consumption,
+        this->total_link_consumption,
+        this->total_disk_consumption,
+        this->extrapolated ? 1 : 0
+    );
+}
+
+optional<SimulationResult> SimulationResult::deserialize(const string &line)
+{
+    SimulationResult result;
+    unsigned nb_fields = 0;
+
+    istringstream stream(line);
+    string token;
+
+    while (stream >> token)
+    {
+        auto separator = token.find('=');
+        if (separator == string::npos)
+            continue;
+
+        auto key = token.substr(0, separator);
+        double value = stod(token.substr(separator + 1));
+
+        switch (str2int(key.c_str()))
+        {
+            case str2int("simulation_time"):
+                result.simulation_time = value;
+                break;
+            case str2int("total_host_consumption"):
+                result.total_host_consumption = value;
+                break;
+            case str2int("used_host_consumption"):
+                result.used_host_consumption = value;
+                break;
+            case str2int("idle_host_consumption"):
+                result.idle_host_consumption = value;
+                break;
+            case str2int("total_link_consumption"):
+                result.total_link_consumption = value;
+                break;
+            case str2int("total_disk_consumption"):
+                result.total_disk_consumption = value;
+                break;
+            case str2int("extrapolated"):
+                // Optional field
+                result.extrapolated = value != 0.0;
+                continue;
+            default:
+                continue;
+        }
+
+        nb_fields++;
+    }
+
+    if (nb_fields < 6)
+        return nullopt;
+
+    return result;
+}
+
+void SimulationResult::print(const string &origin) const
+{
+    XBT_INFO("Simulation result%s: %s", origin.empty() ? "" : std::format(" ({})", origin).c_str(), this->serialize().c_str());
+}
+
+/** Feed the hash with bytes, separated from the next ones so that moving bytes from one input to the other changes it */
+static void hash_bytes(uint64_t &hash, const string &bytes)
+{
+    hash = fnv1a_hash(bytes, hash);
+    hash = fnv1a_hash("\xff", hash);
+}
+
+static string read_file(const char *path)
+{
+    ifstream file(path, ios::binary);
+    xbt_assert(file.is_open(), "Couldn't open %s", path);
+
+    stringstream content;
+    content << file.rdbuf();
+
+    return content.str();
+}
+
+/**
+ * Canonical form of a fried file: constants are resolved the same way the config loader does, i.e. sorted by name
+ * with empty values ignored, and the clusters are serialized without formatting.
+ */
+static string canonical_fried(const char *fried_path)
+{
+    pugi::xml_document doc;
+    xbt_assert(doc.load_file(fried_path), "Error while loading fried falafels deployment file");
+
+    auto root_elem = doc.child("fried");
+
+    map<string, string> constants;
+    for (auto constant: root_elem.child("constants").children())
+    {
+        auto value = constant.attribute("value");
+
+        if (!value.empty())
+            constants[constant.attribute("name").as_string()] = value.as_string();
+    }
+
+    stringstream canonical;
+
+    for (auto &[name, value]: constants)
+        canonical << name << '=' << value << ';';
+
+    for (auto cluster: root_elem.children("cluster"))
+        cluster.print(canonical, "", pugi::format_raw);
+
+    return canonical.str();
+}
+
+/**
+ * Feed the hash with the contents of the files referenced by an XML file: trace files of the platform (speed_file,
+ * bandwidth_file...) and of the fried profiles (file). Relative paths are looked up from the working directory, then
+ * next to the XML file as SimGrid does.
+ */
+static void hash_referenced_files(uint64_t &hash, const char *xml_path)
+{
+    pugi::xml_document doc;
+    xbt_assert(doc.load_file(xml_path), "Error while loading %s", xml_path);
+
+    vector<pugi::xml_node> pending { doc.document_element() };
+
+    while (!pending.empty())
+    {
+        auto elem = pending.back();
+        pending.pop_back();
+
+        for (auto attribute: elem.attributes())
+        {
+            string_view name(attribute.name());
+
+            if (name != "file" && !name.ends_with("_file"))
+                continue;
+
+            filesystem::path path(attribute.as_string());
+
+            if (!filesystem::exists(path))
+                path = filesystem::path(xml_path).parent_path() / path;
+
+            hash_bytes(hash, read_file(path.c_str()));
+        }
+
+        for (auto child: elem.children())
+            pending.push_back(child);
+    }
+}
+
+ResultCache::ResultCache(string cache_dir, const char *platform_path, const char *fried_path,
+                         vector<string> cfg_flags) : cache_dir(cache_dir)
+{
+    uint64_t hash = fnv1a_hash("");
+
+    hash_bytes(hash, read_file(platform_path));
+    hash_referenced_files(hash, platform_path);
+    hash_bytes(hash, canonical_fried(fried_path));
+    hash_referenced_files(hash, fried_path);
+    hash_bytes(hash, FALAFELS_VERSION);
+
+    // The order of --cfg flags doesn't matter as long as each option is only given once
+    ranges::sort(cfg_flags);
+
+    for (auto &cfg_flag: cfg_flags)
+        hash_bytes(hash, cfg_flag);
+
+    this->entry_path = std::format("{}/{:016x}.result", cache_dir, hash);
+}
+
+optional<SimulationResult> ResultCache::lookup()
+{
+    ifstream entry(this->entry_path);
+
+    if (!entry.is_open())
+        return nullopt;
+
+    string line;
+    getline(entry, line);
+
+    return SimulationResult::deserialize(line);
+}
+
+void ResultCache::store(const SimulationResult &result)
+{
+    filesystem::create_directories(this->cache_dir);
+
+    // Write then rename so that simulations running concurrently never read a partial entry
+    auto tmp_path = std::format("{}.{}.tmp", this->entry_path, getpid());
+
+    ofstream tmp(tmp_path);
+    tmp << result.serialize() << '\n';
+    tmp.close();
+
+    filesystem::rename(tmp_path, this->entry_path);
+
+    XBT_INFO("Stored the result in %s", this->entry_path.c_str());
+}
@@ -0,0 +1,83 @@
+#ifndef FALAFELS_RESULT_HPP
+#define FALAFELS_RESULT_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Outcome of a simulation as reported to the tools driving the simulator, such as the beagle.
+ * Energies are in Joules and the simulation time in seconds.
+ */
+struct SimulationResult
+{
+    double simulation_time = 0.0;
+    double total_host_consumption = 0.0;
+    double used_host_consumption = 0.0;
+    double idle_host_consumption = 0.0;
+    double total_link_consumption = 0.0;
+    /** Energy of the disks trainers read their dataset from, see Constants::DATASET_SAMPLE_SIZE_BYTES */
+    double total_disk_consumption = 0.0;
+
+    /** Whether some rounds were extrapolated instead of simulated, see Constants::STEADY_STATE_ROUNDS */
+    bool extrapolated = false;
+
+    /** Energy consumed by hosts, links and disks */
+    double get_total_consumption() const
+    {
+        return this->total_host_consumption + this->total_link_consumption + this->total_disk_consumption;
+    }
+
+    /** Set the hosts on which a Node was deployed, the other ones are accounted as idle */
+    static void set_used_hosts(const std::vector<std::string> &used_hosts);
+
+    /** Measure the simulation up to the current time, can also be called by actors while the simulation runs */
+    static SimulationResult collect();
+
+    /** Register rounds of the job of a main aggregator that won't be simulated, each one adding round_delta to the result */
+    static void set_extrapolation(const std::string &aggregator_name, uint64_t number_rounds,
+                                  const SimulationResult &round_delta);
+
+    /** Add the rounds registered with set_extrapolation(), if any, the extrapolations of several jobs overlapping */
+    void apply_extrapolation();
+
+    /** Whether every field of other is within the relative tolerance of ours */
+    bool agrees_with(const SimulationResult &other, double tolerance) const;
+
+    SimulationResult operator-(const SimulationResult &other) const;
+
+    /** Parse a result written by serialize(), returns nothing if a field is missing */
+    static std::optional<SimulationResult> deserialize(const std::string &line);
+
+    /** Single line `key=value` representation, doubles are written with enough digits to be read back exactly */
+    std::string serialize() const;
+
+    /** Log the result in the structured format parsed by the beagle, origin tells if it was cached or estimated */
+    void print(const std::string &origin="") const;
+};
+
+/**
+ * On-disk store of simulation results, keyed by a hash of everything that determines the outcome of a simulation:
+ * the platform file, the fried file with its constants resolved, the trace files they reference, the SimGrid --cfg flags
+ * and the version of the simulator.
+ */
+class ResultCache
+{
+public:
+    ResultCache(std::string cache_dir, const char *platform_path, const char *fried_path,
+                std::vector<std::string> cfg_flags);
+
+    /** Get the result stored for our inputs, if any */
+    std::optional<SimulationResult> lookup();
+
+    /** Store the result for our inputs, replacing the previous one */
+    void store(const SimulationResult &result);
+private:
+    std::string cache_dir;
+
+    /** Path of the cache entry matching our inputs */
+    std::string entry_path;
+};
+
+#endif // !FALAFELS_RESULT_HPP
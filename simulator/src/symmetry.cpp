@@ -0,0 +1,43 @@
+#include <simgrid/s4u/Engine.hpp>
+#include <simgrid/s4u/Host.hpp>
+#include <xbt/log.h>
+
+#include "symmetry.hpp"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_symmetry, "Messages specific for this example");
+
+using namespace std;
+using namespace protocol;
+
+void SymmetryReduction::add_class(node_name representative, const vector<node_name> &shadows)
+{
+    auto e = simgrid::s4u::Engine::get_instance();
+
+    XBT_INFO("'%s' represents %lu other equivalent trainers", representative.c_str(), shadows.size());
+
+    for (auto &shadow: shadows)
+    {
+        this->shadow_hosts[representative].push_back(e->host_by_name(shadow));
+        this->representatives[shadow] = representative;
+    }
+}
+
+const vector<simgrid::s4u::Host*> &SymmetryReduction::get_shadow_hosts(const node_name &name)
+{
+    auto shadows = this->shadow_hosts.find(name);
+
+    if (shadows == this->shadow_hosts.end())
+        return this->no_shadow_hosts;
+
+    return shadows->second;
+}
+
+optional<node_name> SymmetryReduction::get_representative(const string &host_name)
+{
+    auto representative = this->representatives.find(host_name);
+
+    if (representative == this->representatives.end())
+        return nullopt;
+
+    return representative->second;
+}
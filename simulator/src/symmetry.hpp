@@ -0,0 +1,46 @@
+#ifndef FALAFELS_SYMMETRY_HPP
+#define FALAFELS_SYMMETRY_HPP
+
+#include <optional>
+#include <simgrid/forward.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "protocol.hpp"
+
+/**
+ * Singleton registering the equivalence classes of trainers found by the config loader when SYMMETRY_REDUCTION is set.
+ * Only a representative of each class is simulated. The other trainers of its class become shadows: transfers of the
+ * representative are mirrored from/to their hosts, and they are accounted the energy of the representative's host.
+ */
+class SymmetryReduction
+{
+public:
+    static SymmetryReduction& get_instance()
+    {
+        static SymmetryReduction instance; 
+        return instance;
+    }
+
+    SymmetryReduction(SymmetryReduction const&) = delete;
+    void operator=(SymmetryReduction const&) = delete;
+
+    /** Register a class, only called while loading the deployment */
+    void add_class(protocol::node_name representative, const std::vector<protocol::node_name> &shadows);
+
+    /** Hosts of the shadows of a node, empty if it isn't a representative */
+    const std::vector<simgrid::s4u::Host*> &get_shadow_hosts(const protocol::node_name &name);
+
+    /** Name of the representative simulating the given host, if it is a shadow */
+    std::optional<protocol::node_name> get_representative(const std::string &host_name);
+private:
+    SymmetryReduction() {}
+
+    std::unordered_map<protocol::node_name, std::vector<simgrid::s4u::Host*>> shadow_hosts;
+    std::unordered_map<std::string, protocol::node_name> representatives;
+
+    const std::vector<simgrid::s4u::Host*> no_shadow_hosts;
+};
+
+#endif // !FALAFELS_SYMMETRY_HPP
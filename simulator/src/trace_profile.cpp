@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <numbers>
+#include <random>
+#include <simgrid/kernel/ProfileBuilder.hpp>
+#include <sstream>
+#include <xbt/asserts.h>
+#include <xbt/log.h>
+
+#include "trace_profile.hpp"
+#include "utils/utils.hpp"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_trace_profile, "Messages specific for this example");
+
+using namespace std;
+using namespace pugi;
+
+/** One period of a sinusoid going from min to max and back, starting at min */
+static string generate_diurnal(double period, double step, double min, double max, double nominal_value)
+{
+    stringstream trace;
+
+    for (double date = 0.0; date < period; date += step)
+    {
+        double factor = min + (max - min) * (1.0 - cos(2.0 * numbers::pi * date / period)) / 2.0;
+        trace << date << ' ' << factor * nominal_value << '\n';
+    }
+
+    return trace.str();
+}
+
+/** Random walk bounded by min and max, starting at max */
+static string generate_random_walk(uint64_t length, double step, double min, double max, double amplitude,
+                                   uint64_t seed, const string &name, double nominal_value)
+{
+    auto generator = create_named_generator(seed, name);
+    uniform_real_distribution<double> move(-amplitude, amplitude);
+
+    stringstream trace;
+    double factor = max;
+
+    for (uint64_t i = 0; i < length; i++)
+    {
+        trace << i * step << ' ' << factor * nominal_value << '\n';
+        factor = clamp(factor + move(generator), min, max);
+    }
+
+    return trace.str();
+}
+
+simgrid::kernel::profile::Profile *create_trace_profile(const xml_node &profile_elem, const string &name,
+                                                        double nominal_value, bool strictly_positive)
+{
+    if (auto file = profile_elem.attribute("file"))
+    {
+        XBT_INFO("Profile %s read from %s", name.c_str(), file.as_string());
+        return simgrid::kernel::profile::ProfileBuilder::from_file(file.as_string());
+    }
+
+    string pattern = profile_elem.attribute("pattern").as_string();
+    double min = profile_elem.attribute("min").as_double(0.1);
+    double max = profile_elem.attribute("max").as_double(1.0);
+
+    xbt_assert(0.0 <= min && min <= max, "Profile %s should have 0 <= min <= max", name.c_str());
+    // A null bandwidth or speed stalls every activity using the resource
+    xbt_assert(!strictly_positive || min > 0.0, "Profile %s should have a positive min", name.c_str());
+
+    string trace;
+    double step;
+
+    switch (str2int(pattern.c_str()))
+    {
+        case str2int("diurnal"):
+            {
+                double period = profile_elem.attribute("period").as_double(86400.0);
+                step = profile_elem.attribute("step").as_double(period / 24.0);
+                xbt_assert(step > 0.0, "Profile %s should have a positive step", name.c_str());
+
+                trace = generate_diurnal(period, step, min, max, nominal_value);
+                break;
+            }
+        case str2int("random-walk"):
+            {
+                step = profile_elem.attribute("step").as_double(60.0);
+                xbt_assert(step > 0.0, "Profile %s should have a positive step", name.c_str());
+
+                trace = generate_random_walk(
+                    profile_elem.attribute("length").as_ullong(1000), step, min, max,
+                    profile_elem.attribute("amplitude").as_double(0.1), profile_elem.attribute("seed").as_ullong(0),
+                    name, nominal_value
+                );
+                break;
+            }
+        default:
+            xbt_die("Profile %s should have a file or a pattern among diurnal and random-walk", name.c_str());
+    }
+
+    XBT_INFO("Profile %s generated with the %s pattern", name.c_str(), pattern.c_str());
+
+    // The pattern repeats itself one step after its last value
+    return simgrid::kernel::profile::ProfileBuilder::from_string(name, trace, step);
+}
+
+bool depends_on_resource_name(const xml_node &profile_elem)
+{
+    return !profile_elem.attribute("file") && strcmp(profile_elem.attribute("pattern").as_string(), "random-walk") == 0;
+}
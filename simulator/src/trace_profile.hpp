@@ -0,0 +1,29 @@
+#ifndef FALAFELS_TRACE_PROFILE_HPP
+#define FALAFELS_TRACE_PROFILE_HPP
+
+#include <pugixml.hpp>
+#include <simgrid/forward.h>
+#include <string>
+
+/**
+ * Build the SimGrid profile described by a <profile> element of the fried file, either read from its `file` (in the
+ * format of SimGrid's profiles, whose values are used as they are) or generated from its `pattern`:
+ * - diurnal: a sinusoid of the given `period`, going from `min` to `max` and back.
+ * - random-walk: a walk between `min` and `max` starting at `max`, moving by at most `amplitude` at a time, drawn
+ *   from `seed` and name. It repeats itself after `length` steps.
+ * Generated patterns are sampled every `step` seconds, their values being factors of nominal_value. `min` defaults to
+ * 0.1 and `max` to 1.
+ *
+ * @param profile_elem XML element of the profile.
+ * @param name Name of the profile, also used to draw random walks.
+ * @param nominal_value Value of the resource the profile is attached to.
+ * @param strictly_positive Whether the generated values should never be 0, e.g. for bandwidths.
+ * @return The profile, owned by SimGrid.
+ */
+simgrid::kernel::profile::Profile *create_trace_profile(const pugi::xml_node &profile_elem, const std::string &name,
+                                                        double nominal_value, bool strictly_positive=false);
+
+/** Whether the values of the profile depend on the name of the resource it is attached to, as random walks do */
+bool depends_on_resource_name(const pugi::xml_node &profile_elem);
+
+#endif // !FALAFELS_TRACE_PROFILE_HPP
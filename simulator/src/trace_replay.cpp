@@ -0,0 +1,286 @@
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <set>
+#include <simgrid/s4u/ActivitySet.hpp>
+#include <simgrid/s4u/Actor.hpp>
+#include <simgrid/s4u/Comm.hpp>
+#include <simgrid/s4u/Disk.hpp>
+#include <simgrid/s4u/Engine.hpp>
+#include <simgrid/s4u/Host.hpp>
+#include <simgrid/s4u/Mailbox.hpp>
+#include <simgrid/s4u/MessageQueue.hpp>
+#include <simgrid/s4u/Semaphore.hpp>
+#include <sstream>
+#include <unordered_map>
+#include <xbt/asserts.h>
+#include <xbt/log.h>
+
+#include "trace_replay.hpp"
+#include "constants.hpp"
+#include "utils/utils.hpp"
+
+XBT_LOG_NEW_DEFAULT_CATEGORY(s4u_trace_replay, "Messages specific for this example");
+
+using namespace std;
+using namespace protocol;
+
+void TraceRecorder::enable(string output_path)
+{
+    xbt_assert(!Constants::SYMMETRY_REDUCTION, "Traces cannot be recorded with SYMMETRY_REDUCTION");
+    xbt_assert(Constants::CHURN_HEARTBEAT_PERIOD == 0.0, "Traces cannot be recorded with churn");
+
+    this->output_path = output_path;
+    this->enabled = true;
+}
+
+void TraceRecorder::record(string action)
+{
+    auto actor_name = simgrid::s4u::this_actor::get_name();
+    auto host = simgrid::s4u::this_actor::get_host();
+
+    std::lock_guard lock(this->mutex);
+
+    auto &stream = this->streams[actor_name];
+    stream.host = host->get_name();
+    stream.actions.push_back(std::move(action));
+}
+
+void TraceRecorder::record_compute(double flops)
+{
+    this->record(std::format("compute\t{}", flops));
+}
+
+void TraceRecorder::record_read(uint64_t bytes, const string &disk)
+{
+    this->record(std::format("read\t{}\t{}", bytes, disk));
+}
+
+void TraceRecorder::record_sleep(double duration)
+{
+    this->record(std::format("sleep\t{}", duration));
+}
+
+void TraceRecorder::record_pstate(const simgrid::s4u::Host *host, unsigned long pstate)
+{
+    this->record(std::format("pstate\t{}\t{}", host->get_name(), pstate));
+}
+
+void TraceRecorder::record_send(Packet &p)
+{
+    this->record(std::format("send\t{}\t{}\t{}\t{}.{}", p.src, p.dst, p.get_packet_size(), p.id, p.chunk_index));
+}
+
+void TraceRecorder::record_reception(const Packet &p, const node_name &receiver)
+{
+    this->record(std::format("recv\t{}\t{}\t{}.{}", receiver, p.src, p.id, p.chunk_index));
+}
+
+void TraceRecorder::record_notify(const simgrid::s4u::MessageQueue *queue)
+{
+    this->record(std::format("notify\t{}", queue->get_name()));
+}
+
+void TraceRecorder::record_wait(const simgrid::s4u::MessageQueue *queue)
+{
+    this->record(std::format("wait\t{}", queue->get_name()));
+}
+
+void TraceRecorder::save()
+{
+    ofstream file(this->output_path);
+    xbt_assert(file.is_open(), "Cannot write the trace to %s", this->output_path.c_str());
+
+    uint64_t number_actions = 0;
+
+    for (auto &[actor_name, stream]: this->streams)
+    {
+        file << "actor\t" << actor_name << '\t' << stream.host << '\n';
+
+        for (auto &action: stream.actions)
+            file << action << '\n';
+
+        number_actions += stream.actions.size();
+    }
+
+    XBT_INFO("Trace of %zu actors and %lu actions written to %s", this->streams.size(), number_actions,
+             this->output_path.c_str());
+}
+
+/** An actor of the trace, its actions being split into their fields */
+struct ReplayedActor
+{
+    string name;
+    string host;
+    vector<vector<string>> actions;
+};
+
+class TraceReplayer
+{
+public:
+    /** Create the semaphores and mailboxes needed by the actors, before any of them runs */
+    void prepare(const vector<ReplayedActor> &actors);
+
+    void run(const ReplayedActor &actor);
+private:
+    /** One semaphore per MessageQueue of the recorded run */
+    unordered_map<string, simgrid::s4u::SemaphorePtr> semaphores;
+
+    /** Hops received by each mailbox before being waited for, by sender and identifier */
+    unordered_map<string, unordered_map<string, uint64_t>> early_hops;
+
+    void receive(const string &mailbox_name, const string &hop);
+};
+
+void TraceReplayer::prepare(const vector<ReplayedActor> &actors)
+{
+    for (auto &actor: actors)
+    {
+        for (auto &action: actor.actions)
+        {
+            if (action[0] == "notify" || action[0] == "wait")
+            {
+                if (!this->semaphores.contains(action[1]))
+                    this->semaphores[action[1]] = simgrid::s4u::Semaphore::create(0);
+            }
+            else if (action[0] == "recv")
+            {
+                this->early_hops[action[1]];
+            }
+        }
+    }
+}
+
+void TraceReplayer::receive(const string &mailbox_name, const string &hop)
+{
+    auto &early_hops = this->early_hops.at(mailbox_name);
+    auto mailbox = simgrid::s4u::Mailbox::by_name(mailbox_name);
+
+    // Hops may arrive in another order than in the recorded run, the ones that aren't awaited yet are kept for later
+    while (early_hops[hop] == 0)
+    {
+        auto received = mailbox->get_unique<string>();
+        early_hops[*received]++;
+    }
+
+    early_hops[hop]--;
+}
+
+void TraceReplayer::run(const ReplayedActor &actor)
+{
+    auto host = simgrid::s4u::this_actor::get_host();
+
+    for (auto &action: actor.actions)
+    {
+        switch (str2int(action[0].c_str()))
+        {
+            case str2int("compute"):
+                {
+                    // Our computations always use every core, whatever their number on this platform
+                    int nb_core = host->get_core_count();
+                    simgrid::s4u::ActivitySet execs;
+
+                    for (int i = 0; i < nb_core; i++)
+                        execs.push(simgrid::s4u::this_actor::exec_async(stod(action[1]) / nb_core));
+
+                    execs.wait_all();
+                    break;
+                }
+            case str2int("read"):
+                {
+                    auto disks = host->get_disks();
+                    auto disk = find_if(disks.begin(), disks.end(), [&action](simgrid::s4u::Disk *d) {
+                        return d->get_name() == action[2];
+                    });
+
+                    if (disk == disks.end())
+                        disk = disks.begin();
+
+                    xbt_assert(disk != disks.end(), "Actor %s reads a disk, but host %s has none", actor.name.c_str(), host->get_cname());
+                    (*disk)->read(stoull(action[1]));
+                    break;
+                }
+            case str2int("sleep"):
+                simgrid::s4u::this_actor::sleep_for(stod(action[1]));
+                break;
+            case str2int("pstate"):
+                {
+                    auto pstate_host = simgrid::s4u::Engine::get_instance()->host_by_name(action[1]);
+                    unsigned long pstate = stoul(action[2]);
+
+                    xbt_assert(pstate < pstate_host->get_pstate_count(), "Actor %s sets pstate %lu, but host %s only has %lu",
+                               actor.name.c_str(), pstate, pstate_host->get_cname(), pstate_host->get_pstate_count());
+                    pstate_host->set_pstate(pstate);
+                    break;
+                }
+            case str2int("send"):
+                // The sender doesn't wait for its packets, which may never be received as in the recorded run
+                simgrid::s4u::Mailbox::by_name(action[2])
+                    ->put_init(new string(std::format("{}\t{}", action[1], action[4])), stoull(action[3]))
+                    ->detach([](void *hop) { delete (string*) hop; });
+                break;
+            case str2int("recv"):
+                this->receive(action[1], std::format("{}\t{}", action[2], action[3]));
+                break;
+            case str2int("notify"):
+                this->semaphores.at(action[1])->release();
+                break;
+            case str2int("wait"):
+                this->semaphores.at(action[1])->acquire();
+                break;
+            default:
+                xbt_die("Unknown action %s in the trace of %s", action[0].c_str(), actor.name.c_str());
+        }
+    }
+}
+
+vector<string> replay_trace(const char *trace_path)
+{
+    ifstream file(trace_path);
+    xbt_assert(file.is_open(), "Cannot read the trace %s", trace_path);
+
+    vector<ReplayedActor> actors;
+    string line;
+
+    while (getline(file, line))
+    {
+        vector<string> fields;
+        stringstream line_stream(line);
+        for (string field; getline(line_stream, field, '\t');)
+            fields.push_back(field);
+
+        if (fields.empty())
+            continue;
+
+        if (fields[0] == "actor")
+        {
+            xbt_assert(fields.size() == 3, "Malformed actor in trace %s: %s", trace_path, line.c_str());
+            actors.push_back(ReplayedActor { .name = fields[1], .host = fields[2] });
+            continue;
+        }
+
+        xbt_assert(!actors.empty(), "Trace %s should start with an actor", trace_path);
+        actors.back().actions.push_back(fields);
+    }
+
+    auto replayer = make_shared<TraceReplayer>();
+    replayer->prepare(actors);
+
+    auto e = simgrid::s4u::Engine::get_instance();
+    set<string> used_hosts;
+
+    for (auto &actor: actors)
+    {
+        auto host = e->host_by_name_or_null(actor.host);
+        xbt_assert(host != nullptr, "Host %s of the trace isn't part of the platform", actor.host.c_str());
+
+        used_hosts.insert(actor.host);
+
+        simgrid::s4u::Actor::create(actor.name, host, [replayer, actor]() { replayer->run(actor); });
+    }
+
+    XBT_INFO("Replaying %zu actors from %s", actors.size(), trace_path);
+
+    return vector<string>(used_hosts.begin(), used_hosts.end());
+}
@@ -0,0 +1,99 @@
+#ifndef FALAFELS_TRACE_REPLAY_HPP
+#define FALAFELS_TRACE_REPLAY_HPP
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <simgrid/forward.h>
+#include <string>
+#include <vector>
+
+#include "protocol.hpp"
+
+/**
+ * Singleton recording the actions of every actor of the simulation, enabled with --record-trace=FILE, so that the
+ * same run can be replayed on other platforms without running the Roles and NetworkManagers again, see replay_trace().
+ *
+ * Each actor gets its own sequence of actions, in the order they happened:
+ * - compute: flops computed by the host, over all its cores.
+ * - read: bytes read from a disk of the host.
+ * - sleep: seconds spent waiting for the host to wake up, or for a reception that timed out.
+ * - send and recv: a packet hop with its size, identified by its sender, receiver, id and chunk.
+ * - notify and wait: a put and a get on a MessageQueue of a Mediator, i.e. the Role and the NetworkManager of a
+ *   Node waiting for one another.
+ * - pstate: a host set to another pstate, by DVFS or by a trainer falling asleep and waking up.
+ * The trace is written at the end of the simulation as tab-separated lines, every actor starting with a line giving
+ * its name and host.
+ */
+class TraceRecorder
+{
+public:
+    static TraceRecorder& get_instance()
+    {
+        static TraceRecorder instance;
+        return instance;
+    }
+
+    TraceRecorder(TraceRecorder const&) = delete;
+    void operator=(TraceRecorder const&) = delete;
+
+    /** Start recording, must be called once the deployment is loaded and before the simulation starts */
+    void enable(std::string output_path);
+
+    bool is_enabled() { return this->enabled; }
+
+    /** Record flops computed by the current actor, over all the cores of its host */
+    void record_compute(double flops);
+
+    void record_read(uint64_t bytes, const std::string &disk);
+
+    void record_sleep(double duration);
+
+    /** Record the pstate of a host being changed, the host not being necessarily the one of the current actor */
+    void record_pstate(const simgrid::s4u::Host *host, unsigned long pstate);
+
+    /** Record a packet hop, when it is sent by its src and when it is received by the given NetworkManager */
+    void record_send(protocol::Packet &p);
+    void record_reception(const protocol::Packet &p, const protocol::node_name &receiver);
+
+    /** Record a put or a completed get on a MessageQueue of a Mediator */
+    void record_notify(const simgrid::s4u::MessageQueue *queue);
+    void record_wait(const simgrid::s4u::MessageQueue *queue);
+
+    /** Write the trace */
+    void save();
+private:
+    TraceRecorder() {}
+
+    bool enabled = false;
+    std::string output_path;
+
+    struct Stream
+    {
+        std::string host;
+        std::vector<std::string> actions;
+    };
+
+    /** Actions of each actor, ordered by actor name so that traces of identical runs are identical */
+    std::map<std::string, Stream> streams;
+
+    /** Actors of several threads may record at once, see --threads */
+    std::mutex mutex;
+
+    /** Append an action to the stream of the current actor */
+    void record(std::string action);
+};
+
+/**
+ * Create one actor per actor of a trace recorded by TraceRecorder, which performs its actions on the loaded
+ * platform: computations and disk reads on its host, sends as detached communications carrying the identifier of the
+ * hop, receptions waiting for the hop they were matched with, notify/wait as semaphores, and pstate changes on the
+ * hosts of the same names.
+ * The platform has to provide the hosts of the trace, its Engine then has to be run.
+ *
+ * @param trace_path File written by TraceRecorder.
+ * @return Names of the hosts used by the trace.
+ */
+std::vector<std::string> replay_trace(const char *trace_path);
+
+#endif // !FALAFELS_TRACE_REPLAY_HPP
@@ -1,6 +1,9 @@
+#include <random>
+#include <sstream>
 #include <vector>
 #include <string>
 
+#include "utils.hpp"
 #include "../node/node.hpp"
 
 // Source: https://stackoverflow.com/questions/5878775/how-to-find-and-replace-string
@@ -16,3 +19,42 @@ void replace_all(std::string& s, std::string const& toReplace, std::string const
 {
     while (replace_first(s, toReplace, replaceWith));
 }
+
+uint64_t fnv1a_hash(const std::string &bytes, uint64_t hash)
+{
+    for (unsigned char c: bytes)
+    {
+        hash ^= c;
+        hash *= 0x100000001b3;
+    }
+
+    return hash;
+}
+
+std::mt19937_64 create_named_generator(uint64_t seed, const std::string &name)
+{
+    std::seed_seq seeds { seed, fnv1a_hash(name) };
+    return std::mt19937_64(seeds);
+}
+
+std::vector<double> parse_wattages(const char *property, unsigned long pstate)
+{
+    std::vector<double> wattages;
+
+    if (property == nullptr)
+        return wattages;
+
+    std::stringstream pstates(property);
+    std::string values;
+
+    for (unsigned long i = 0; i <= pstate; i++)
+        std::getline(pstates, values, ',');
+
+    std::stringstream values_stream(values);
+    std::string value;
+
+    while (std::getline(values_stream, value, ':'))
+        wattages.push_back(std::stod(value));
+
+    return wattages;
+}
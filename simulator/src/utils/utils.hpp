@@ -1,6 +1,8 @@
 #ifndef FALAFELS_UTILS_HPP
 #define FALAFELS_UTILS_HPP
 
+#include "cstdint"
+#include "random"
 #include "string"
 #include "vector"
 
@@ -13,6 +15,21 @@ constexpr unsigned int str2int(const char* str, int h = 0)
 bool replace_first(std::string& s, std::string const& toReplace, std::string const& replaceWith);
 void replace_all(std::string& s, std::string const& toReplace, std::string const& replaceWith);
 
+/** 
+ * Parse a SimGrid energy property such as wattage_per_state="idle:one_core:all_cores". When several pstates are
+ * listed, separated by commas, the values of the given pstate are returned. Empty if the property isn't set.
+ */
+std::vector<double> parse_wattages(const char *property, unsigned long pstate);
+
+/** 64 bits FNV-1a hash of bytes, which can be fed incrementally by passing the hash of the previous bytes */
+uint64_t fnv1a_hash(const std::string &bytes, uint64_t hash=0xcbf29ce484222325);
+
+/** 
+ * Random generator drawing its own stream from seed and name, e.g. a host name, so that its values don't depend on the
+ * order in which generators are created.
+ */
+std::mt19937_64 create_named_generator(uint64_t seed, const std::string &name);
+
 // Tool to use lambdas in std::visit (for std::variant), see: https://en.cppreference.com/w/cpp/utility/variant/visit
 template<class... Ts>
 struct overloaded : Ts... { using Ts::operator()...; };
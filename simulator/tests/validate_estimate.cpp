@@ -0,0 +1,78 @@
+/* Validation of --estimate against a full simulation of the same deployment */
+#include <cmath>
+#include <cstdio>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "../src/result.hpp"
+
+using namespace std;
+
+/** Run the simulator and parse the last result line starting with prefix */
+static optional<SimulationResult> run_simulator(const string &command, string_view prefix)
+{
+    // SimGrid logs on stderr
+    FILE *output = popen(std::format("{} 2>&1", command).c_str(), "r");
+    if (output == nullptr)
+        return nullopt;
+
+    optional<SimulationResult> result;
+    char buffer[4096];
+
+    while (fgets(buffer, sizeof(buffer), output) != nullptr)
+    {
+        string_view line(buffer);
+        auto position = line.find(prefix);
+
+        if (position != string_view::npos)
+            result = SimulationResult::deserialize(string(line.substr(position + prefix.size())));
+    }
+
+    if (pclose(output) != 0)
+        return nullopt;
+
+    return result;
+}
+
+/** Whether estimated is within the relative tolerance of simulated, logging both */
+static bool check(string_view field, double estimated, double simulated, double tolerance)
+{
+    double error = simulated != 0.0 ? abs(estimated - simulated) / simulated : abs(estimated);
+    bool ok = error <= tolerance;
+
+    cerr << std::format("{}: estimated={} simulated={} error={:.1f}% {}\n", field, estimated, simulated, error * 100.0,
+                        ok ? "OK" : "FAILED");
+
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 5)
+    {
+        cerr << std::format("Usage: {} simulator platform_file deployment_file tolerance\n", argv[0]);
+        return 1;
+    }
+
+    string command = std::format("\"{}\" \"{}\" \"{}\"", argv[1], argv[2], argv[3]);
+    double tolerance = stod(argv[4]);
+
+    auto simulated = run_simulator(command, "Simulation result: ");
+    auto estimated = run_simulator(command + " --estimate", "Simulation result (estimated): ");
+
+    if (!simulated || !estimated)
+    {
+        cerr << "The simulator didn't print a result\n";
+        return 1;
+    }
+
+    // Evaluate every check so that all the errors are logged
+    bool ok = check("simulation_time", estimated->simulation_time, simulated->simulation_time, tolerance);
+    ok = check("total_host_consumption", estimated->total_host_consumption, simulated->total_host_consumption, tolerance) && ok;
+    ok = check("total_link_consumption", estimated->total_link_consumption, simulated->total_link_consumption, tolerance) && ok;
+
+    return ok ? 0 : 1;
+}